@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <omp.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "config.cpp"
+
+using namespace std;
+
+/**
+ * How firefly-level threads are placed on CPUs
+ */
+enum class PinPolicy
+{
+    // Leave placement to the operating system
+    None,
+    // Fill the hardware threads of a core, then the cores of a package, then the next package
+    Compact,
+    // Spread over packages first, then over cores, then over the hardware threads of a core
+    Scatter,
+    // CPUs given explicitly, in thread order
+    List
+};
+
+/**
+ * One logical CPU and where it sits
+ */
+struct CpuInfo
+{
+    int cpu;
+    int package;
+    int core;
+    int node;
+    // Index among the hardware threads of its core
+    int smt;
+};
+
+/**
+ * Logical CPUs this process may run on
+ */
+struct Topology
+{
+    vector<CpuInfo> cpus;
+    int packages = 1;
+    int cores = 1;
+    int nodes = 1;
+};
+
+#ifndef _WIN32
+/**
+ * First integer of a sysfs file, or fallback when it cannot be read
+ */
+inline int readSysfsInt(const string &path, int fallback)
+{
+    ifstream file(path);
+    int value;
+
+    return file >> value ? value : fallback;
+}
+#endif
+
+/**
+ * Read the package, core and NUMA node of every CPU in the affinity mask of the process
+ * Linux reads sysfs, elsewhere every CPU is its own core on one package and one node
+ */
+inline Topology readTopology()
+{
+    Topology topology;
+
+#ifdef _WIN32
+    for (int cpu = 0; cpu < (int)thread::hardware_concurrency(); ++cpu)
+        topology.cpus.push_back({cpu, 0, cpu, 0, 0});
+#else
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+
+        const string base = "/sys/devices/system/cpu/cpu" + to_string(cpu);
+        CpuInfo info{cpu, readSysfsInt(base + "/topology/physical_package_id", 0), readSysfsInt(base + "/topology/core_id", cpu), 0, 0};
+
+        // The node of a CPU is the nodeN link in its sysfs directory
+        error_code error;
+
+        for (const auto &entry : filesystem::directory_iterator(base, error))
+        {
+            const string name = entry.path().filename().string();
+
+            if (name.rfind("node", 0) == 0 && name.size() > 4 && isdigit(name[4]))
+                info.node = stoi(name.substr(4));
+        }
+
+        topology.cpus.push_back(info);
+    }
+#endif
+
+    if (topology.cpus.empty())
+        topology.cpus.push_back({0, 0, 0, 0, 0});
+
+    sort(topology.cpus.begin(), topology.cpus.end(), [](const CpuInfo &a, const CpuInfo &b)
+         { return tie(a.package, a.core, a.cpu) < tie(b.package, b.core, b.cpu); });
+
+    vector<int> packages;
+    vector<int> nodes;
+    int cores = 0;
+
+    for (size_t i = 0; i < topology.cpus.size(); ++i)
+    {
+        CpuInfo &info = topology.cpus[i];
+        const bool sameCore = i > 0 && topology.cpus[i - 1].package == info.package && topology.cpus[i - 1].core == info.core;
+
+        // Sorted by package and core, so the hardware threads of a core are adjacent
+        info.smt = sameCore ? topology.cpus[i - 1].smt + 1 : 0;
+        cores += sameCore ? 0 : 1;
+
+        if (find(packages.begin(), packages.end(), info.package) == packages.end())
+            packages.push_back(info.package);
+
+        if (find(nodes.begin(), nodes.end(), info.node) == nodes.end())
+            nodes.push_back(info.node);
+    }
+
+    topology.packages = packages.size();
+    topology.cores = cores;
+    topology.nodes = nodes.size();
+
+    return topology;
+}
+
+/**
+ * CPU of every thread slot under a policy, empty when threads are not pinned
+ * A list policy takes the CPUs as given, the others order the CPUs of the topology
+ */
+inline vector<int> placeThreads(const Topology &topology, PinPolicy policy, const vector<int> &cpuList)
+{
+    if (policy == PinPolicy::None)
+        return {};
+
+    if (policy == PinPolicy::List)
+        return cpuList;
+
+    vector<CpuInfo> order = topology.cpus;
+
+    if (policy == PinPolicy::Compact)
+    {
+        sort(order.begin(), order.end(), [](const CpuInfo &a, const CpuInfo &b)
+             { return tie(a.node, a.package, a.core, a.smt) < tie(b.node, b.package, b.core, b.smt); });
+    }
+    else
+    {
+        // Rank of every core within its package, so the n-th core of each package comes before the n+1-th of any
+        vector<int> coreRank(order.size());
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            for (size_t j = 0; j < order.size(); ++j)
+            {
+                if (order[j].package == order[i].package && order[j].smt == 0 && order[j].core < order[i].core)
+                    coreRank[i]++;
+            }
+        }
+
+        vector<int> index(order.size());
+
+        for (size_t i = 0; i < index.size(); ++i)
+            index[i] = i;
+
+        sort(index.begin(), index.end(), [&](int a, int b)
+             { return tie(order[a].smt, coreRank[a], order[a].package) < tie(order[b].smt, coreRank[b], order[b].package); });
+
+        vector<CpuInfo> scattered;
+
+        for (int i : index)
+            scattered.push_back(order[i]);
+
+        order = scattered;
+    }
+
+    vector<int> placement;
+
+    for (const CpuInfo &info : order)
+        placement.push_back(info.cpu);
+
+    return placement;
+}
+
+/**
+ * Index of the calling thread across all levels of nested teams
+ * Concurrent runs times their firefly-level threads get distinct slots
+ */
+inline int threadSlot()
+{
+    int slot = 0;
+
+    for (int level = 1; level <= omp_get_level(); ++level)
+        slot = slot * omp_get_team_size(level) + omp_get_ancestor_thread_num(level);
+
+    return slot;
+}
+
+/**
+ * Bind the calling thread to the CPU of its slot, OpenMP reuses its threads so this is a no-op once bound
+ */
+inline void pinThread(const vector<int> &placement)
+{
+    if (placement.empty())
+        return;
+
+    thread_local int boundCpu = -1;
+    const int cpu = placement[threadSlot() % placement.size()];
+
+    if (cpu == boundCpu)
+        return;
+
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+    boundCpu = cpu;
+}
+
+/**
+ * Parse CPU lists such as 0,2,4-7
+ */
+inline vector<int> parseCpuList(const Setting &setting)
+{
+    vector<int> cpus;
+
+    for (const string &item : splitList(setting.value))
+    {
+        const size_t dash = item.find('-');
+
+        if (dash == string::npos)
+        {
+            cpus.push_back(parseNumber<int>(setting, item));
+            continue;
+        }
+
+        const int first = parseNumber<int>(setting, trim(item.substr(0, dash)));
+        const int last = parseNumber<int>(setting, trim(item.substr(dash + 1)));
+
+        if (first > last)
+            throw runtime_error("invalid CPU range " + item + " for " + setting.key);
+
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+
+    if (cpus.empty())
+        throw runtime_error("empty CPU list for " + setting.key);
+
+    return cpus;
+}
+
+/**
+ * Compress a list of CPUs into ranges, 0-3,8,10-11
+ */
+inline string formatCpuList(vector<int> cpus)
+{
+    sort(cpus.begin(), cpus.end());
+    cpus.erase(unique(cpus.begin(), cpus.end()), cpus.end());
+
+    string text;
+
+    for (size_t i = 0; i < cpus.size();)
+    {
+        size_t j = i;
+
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            ++j;
+
+        if (!text.empty())
+            text += ',';
+
+        text += to_string(cpus[i]);
+
+        if (j > i)
+        {
+            text += '-';
+            text += to_string(cpus[j]);
+        }
+
+        i = j + 1;
+    }
+
+    return text;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include "population.cpp"
+
+using namespace std;
+
+/**
+ * Hint to the core that we are busy-waiting
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    _mm_pause();
+#endif
+}
+
+/**
+ * Sense-reversing barrier for a team that stays alive across generations
+ * Arrival is one atomic increment, waiting spins, spins then yields, or sleeps on the phase word
+ * (atomic wait is a futex on Linux and WaitOnAddress on Windows)
+ */
+class SpinBarrier
+{
+public:
+    SpinBarrier(int count, BarrierWait wait) : count(count), wait(wait)
+    {
+    }
+
+    /**
+     * Change the number of participating threads, only while nobody is waiting
+     */
+    void reset(int newCount)
+    {
+        count = newCount;
+        arrived.store(0, memory_order_relaxed);
+    }
+
+    void arriveAndWait()
+    {
+        const uint32_t currentPhase = phase.load(memory_order_acquire);
+
+        // The last thread to arrive opens the next phase
+        if (arrived.fetch_add(1, memory_order_acq_rel) + 1 == count)
+        {
+            arrived.store(0, memory_order_relaxed);
+            phase.fetch_add(1, memory_order_release);
+
+            if (wait == BarrierWait::Futex)
+                phase.notify_all();
+
+            return;
+        }
+
+        for (int spins = 0; phase.load(memory_order_acquire) == currentPhase; ++spins)
+        {
+            if (wait == BarrierWait::Spin || spins < spinLimit)
+                cpuRelax();
+            else if (wait == BarrierWait::SpinYield)
+                this_thread::yield();
+            else
+                phase.wait(currentPhase, memory_order_acquire);
+        }
+    }
+
+private:
+    // Spins before a spin-then-yield or futex barrier gives up the core
+    static constexpr int spinLimit = 2000;
+
+    int count;
+    BarrierWait wait;
+    alignas(cacheLineSize) atomic<int> arrived{0};
+    alignas(cacheLineSize) atomic<uint32_t> phase{0};
+};
+
+/**
+ * Per-thread accumulated seconds, padded so threads never share a cache line
+ */
+struct alignas(cacheLineSize) ThreadSeconds
+{
+    double seconds = 0.0;
+};
+
+/**
+ * Per-thread event count, padded like ThreadSeconds
+ */
+struct alignas(cacheLineSize) ThreadCounter
+{
+    long count = 0;
+};
@@ -0,0 +1,487 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "population.cpp"
+
+using namespace std;
+
+/**
+ * 64-bit FNV-1a, fingerprints the settings a checkpoint was written with
+ */
+inline uint64_t fnv1a(const string &text)
+{
+    uint64_t hash = 0xCBF29CE484222325;
+
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
+
+/**
+ * Sizes a checkpoint file is laid out for
+ */
+struct CheckpointShape
+{
+    // Benchmarks of the sweep, one per function, variant and thread count
+    int cells;
+    int runs;
+    // Per-thread statistics kept per run, the largest thread count of the sweep
+    int threadSlots;
+    int population;
+    // Largest dimension of the selected functions
+    int dim;
+};
+
+struct CheckpointHeader
+{
+    char magic[8];
+    uint64_t fingerprint;
+    uint64_t seed;
+    CheckpointShape shape;
+};
+
+/**
+ * Progress of one benchmark
+ */
+struct CellRecord
+{
+    // 0 not started, 1 started, 2 all runs done and the totals below written
+    int state;
+    double elapsedSeconds;
+    // Process CPU time and hardware events per run
+    double cpuSeconds;
+    HardwareCounters counters;
+};
+
+/**
+ * A finished run, followed in the file by threadSlots SchedulerStats and threadSlots PhaseTimes
+ */
+struct RunRecord
+{
+    int done;
+    int schedulerThreads;
+    int phaseThreads;
+    double sample;
+    double bestFitness;
+    double rngSeconds;
+    double syncSeconds;
+    long evaluations;
+    int generations;
+    TargetTelemetry target;
+    long migrants;
+};
+
+/**
+ * State of a run in flight after a completed generation, followed in the file by the population and the fitness
+ * The random streams are counter-based, keyed by seed, run, generation and firefly, so the generation is all
+ * the generator state there is
+ */
+struct RunSnapshot
+{
+    // Increases with every snapshot of the run, 0 while the slot is being written
+    uint64_t stamp;
+    int cell;
+    int generation;
+    double randomness;
+    double elapsedSeconds;
+    double bestSoFar;
+    int stagnantGenerations;
+    long evaluations;
+    double rngSeconds;
+    double syncSeconds;
+    TargetTelemetry target;
+    long migrants;
+};
+
+/**
+ * Sweep progress and in-flight runs in a memory-mapped file
+ * Records are written in place, the operating system writes the pages back, so a checkpoint costs a few stores and
+ * the file survives the process. Every run has two snapshot slots written alternately, so a process killed half-way
+ * through a snapshot leaves the previous one intact.
+ */
+class Checkpoint
+{
+public:
+    ~Checkpoint()
+    {
+        close();
+    }
+
+    /**
+     * Map the file, creating it afresh or, when resuming, checking it was written with the same settings
+     */
+    void open(const string &filePath, const CheckpointShape &shape, uint64_t fingerprint, uint64_t seed, bool resume)
+    {
+        path = filePath;
+        layout = shape;
+        size = layoutBytes(shape);
+
+        map(resume);
+
+        CheckpointHeader &fileHeader = header();
+
+        if (resume)
+        {
+            if (memcmp(fileHeader.magic, "FFCKPT1", 8) != 0 || fileHeader.fingerprint != fingerprint || memcmp(&fileHeader.shape, &shape, sizeof(shape)) != 0)
+            {
+                close();
+                throw runtime_error("checkpoint " + path + " was written with other settings");
+            }
+
+            return;
+        }
+
+        memset(base, 0, size);
+        memcpy(fileHeader.magic, "FFCKPT1", 8);
+        fileHeader.fingerprint = fingerprint;
+        fileHeader.seed = seed;
+        fileHeader.shape = shape;
+    }
+
+    bool enabled() const
+    {
+        return base != nullptr;
+    }
+
+    /**
+     * Seed of the sweep, a resumed sweep continues with the seed it started with
+     */
+    uint64_t seed() const
+    {
+        return header().seed;
+    }
+
+    CellRecord &cell(int index) const
+    {
+        return reinterpret_cast<CellRecord *>(base + headerBytes())[index];
+    }
+
+    int cellsDone() const
+    {
+        int done = 0;
+
+        for (int index = 0; index < layout.cells; ++index)
+            done += cell(index).state == 2 ? 1 : 0;
+
+        return done;
+    }
+
+    /**
+     * Make cell the benchmark the run records and snapshots belong to
+     */
+    void beginCell(int index)
+    {
+        current = index;
+        cell(index).state = max(cell(index).state, 1);
+    }
+
+    /**
+     * The recorded result and sample of a finished run of the current cell, false when it has not finished
+     */
+    bool finishedRun(int run, FireflyResult &result, double &sample) const
+    {
+        const RunRecord &record = runRecord(current, run);
+
+        if (!record.done)
+            return false;
+
+        const SchedulerStats *scheduler = runScheduler(current, run);
+        const PhaseTimes *phases = runPhases(current, run);
+
+        result = {
+            .bestFitness = record.bestFitness,
+            .rngSeconds = record.rngSeconds,
+            .syncSeconds = record.syncSeconds,
+            .scheduler = vector<SchedulerStats>(scheduler, scheduler + record.schedulerThreads),
+            .evaluations = record.evaluations,
+            .generations = record.generations,
+            .target = record.target,
+            .phases = vector<PhaseTimes>(phases, phases + record.phaseThreads),
+            .migrants = record.migrants,
+        };
+        sample = record.sample;
+
+        return true;
+    }
+
+    void finishRun(int run, const FireflyResult &result, double sample)
+    {
+        RunRecord &record = runRecord(current, run);
+        const int schedulerThreads = min<int>(result.scheduler.size(), layout.threadSlots);
+        const int phaseThreads = min<int>(result.phases.size(), layout.threadSlots);
+
+        record = {
+            .done = 0,
+            .schedulerThreads = schedulerThreads,
+            .phaseThreads = phaseThreads,
+            .sample = sample,
+            .bestFitness = result.bestFitness,
+            .rngSeconds = result.rngSeconds,
+            .syncSeconds = result.syncSeconds,
+            .evaluations = result.evaluations,
+            .generations = result.generations,
+            .target = result.target,
+            .migrants = result.migrants,
+        };
+
+        copy_n(result.scheduler.begin(), schedulerThreads, runScheduler(current, run));
+        copy_n(result.phases.begin(), phaseThreads, runPhases(current, run));
+
+        // The record only counts once everything before it is written
+        atomic_thread_fence(memory_order_release);
+        record.done = 1;
+        flush();
+    }
+
+    void finishCell(double elapsedSeconds, double cpuSeconds, const HardwareCounters &counters)
+    {
+        CellRecord &record = cell(current);
+        record.elapsedSeconds = elapsedSeconds;
+        record.cpuSeconds = cpuSeconds;
+        record.counters = counters;
+
+        atomic_thread_fence(memory_order_release);
+        record.state = 2;
+        flush();
+    }
+
+    /**
+     * Latest complete snapshot of a run of the current cell, null when there is none
+     */
+    const RunSnapshot *snapshot(int run) const
+    {
+        const RunSnapshot *latest = nullptr;
+
+        for (int slot = 0; slot < 2; ++slot)
+        {
+            const RunSnapshot *candidate = snapshotSlot(run, slot);
+
+            if (candidate->stamp > 0 && candidate->cell == current && (!latest || candidate->stamp > latest->stamp))
+                latest = candidate;
+        }
+
+        return latest;
+    }
+
+    /**
+     * Slot the next snapshot of a run goes to, the older of the two, marked as being written
+     */
+    RunSnapshot *beginSnapshot(int run)
+    {
+        RunSnapshot *first = snapshotSlot(run, 0);
+        RunSnapshot *second = snapshotSlot(run, 1);
+        RunSnapshot *older = first->cell != current || (second->cell == current && first->stamp <= second->stamp) ? first : second;
+
+        older->stamp = 0;
+        atomic_thread_fence(memory_order_release);
+
+        return older;
+    }
+
+    /**
+     * Mark a written slot complete, newer than the other slot of its run
+     */
+    void endSnapshot(int run, RunSnapshot *slot)
+    {
+        const RunSnapshot *other = snapshotSlot(run, slot == snapshotSlot(run, 0) ? 1 : 0);
+        const uint64_t stamp = (other->cell == current ? other->stamp : 0) + 1;
+
+        slot->cell = current;
+        atomic_thread_fence(memory_order_release);
+        slot->stamp = stamp;
+        flush();
+    }
+
+    /**
+     * Population of a snapshot, firefly i at i * dim, and the fitness after it
+     */
+    static double *snapshotValues(const RunSnapshot *slot)
+    {
+        return reinterpret_cast<double *>(const_cast<RunSnapshot *>(slot) + 1);
+    }
+
+    // Seconds between snapshots of a run in flight, 0 snapshots after every generation
+    double interval = 30.0;
+
+private:
+    /**
+     * Map the file, which has to exist when resuming
+     */
+    void map(bool resume)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, resume ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+            throw runtime_error("cannot open checkpoint " + path);
+
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+
+        if (resume && (size_t)fileSize.QuadPart != size)
+        {
+            close();
+            throw runtime_error("checkpoint " + path + " was written with other settings");
+        }
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(uint64_t(size) >> 32), DWORD(size), nullptr);
+        base = mapping ? static_cast<char *>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size)) : nullptr;
+#else
+        fd = ::open(path.c_str(), resume ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if (fd < 0)
+            throw runtime_error("cannot open checkpoint " + path);
+
+        struct stat status;
+        fstat(fd, &status);
+
+        if (resume && (size_t)status.st_size != size)
+        {
+            close();
+            throw runtime_error("checkpoint " + path + " was written with other settings");
+        }
+
+        if (!resume && ftruncate(fd, size) != 0)
+        {
+            close();
+            throw runtime_error("cannot size checkpoint " + path);
+        }
+
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        base = memory == MAP_FAILED ? nullptr : static_cast<char *>(memory);
+#endif
+
+        if (!base)
+        {
+            close();
+            throw runtime_error("cannot map checkpoint " + path);
+        }
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (base)
+            UnmapViewOfFile(base);
+
+        if (mapping)
+            CloseHandle(mapping);
+
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base)
+            munmap(base, size);
+
+        if (fd >= 0)
+            ::close(fd);
+
+        fd = -1;
+#endif
+        base = nullptr;
+    }
+
+    /**
+     * Start writing the dirty pages back without waiting, so a machine that goes down loses seconds, not the sweep
+     */
+    void flush()
+    {
+#ifdef _WIN32
+        FlushViewOfFile(base, 0);
+#else
+        msync(base, size, MS_ASYNC);
+#endif
+    }
+
+    static size_t roundUp(size_t bytes)
+    {
+        return (bytes + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+    }
+
+    static size_t headerBytes()
+    {
+        return roundUp(sizeof(CheckpointHeader));
+    }
+
+    static size_t cellBytes(const CheckpointShape &shape)
+    {
+        return roundUp(shape.cells * sizeof(CellRecord));
+    }
+
+    static size_t runBytes(const CheckpointShape &shape)
+    {
+        return roundUp(sizeof(RunRecord) + shape.threadSlots * (sizeof(SchedulerStats) + sizeof(PhaseTimes)));
+    }
+
+    static size_t snapshotBytes(const CheckpointShape &shape)
+    {
+        return roundUp(sizeof(RunSnapshot) + size_t(shape.population) * (shape.dim + 1) * sizeof(double));
+    }
+
+    static size_t layoutBytes(const CheckpointShape &shape)
+    {
+        return headerBytes() + cellBytes(shape) + size_t(shape.cells) * shape.runs * runBytes(shape) + 2 * size_t(shape.runs) * snapshotBytes(shape);
+    }
+
+    CheckpointHeader &header() const
+    {
+        return *reinterpret_cast<CheckpointHeader *>(base);
+    }
+
+    RunRecord &runRecord(int cellIndex, int run) const
+    {
+        return *reinterpret_cast<RunRecord *>(base + headerBytes() + cellBytes(layout) + (size_t(cellIndex) * layout.runs + run) * runBytes(layout));
+    }
+
+    SchedulerStats *runScheduler(int cellIndex, int run) const
+    {
+        return reinterpret_cast<SchedulerStats *>(&runRecord(cellIndex, run) + 1);
+    }
+
+    PhaseTimes *runPhases(int cellIndex, int run) const
+    {
+        return reinterpret_cast<PhaseTimes *>(runScheduler(cellIndex, run) + layout.threadSlots);
+    }
+
+    RunSnapshot *snapshotSlot(int run, int slot) const
+    {
+        const size_t runs = headerBytes() + cellBytes(layout) + size_t(layout.cells) * layout.runs * runBytes(layout);
+
+        return reinterpret_cast<RunSnapshot *>(base + runs + (size_t(run) * 2 + slot) * snapshotBytes(layout));
+    }
+
+    string path;
+    CheckpointShape layout{};
+    size_t size = 0;
+    char *base = nullptr;
+    int current = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * One key = value setting, read from a config file or given on the command line as --key value
+ */
+struct Setting
+{
+    string key;
+    string value;
+};
+
+/**
+ * Strip leading and trailing whitespace
+ */
+inline string trim(const string &text)
+{
+    const size_t first = text.find_first_not_of(" \t\r\n");
+
+    if (first == string::npos)
+        return "";
+
+    const size_t last = text.find_last_not_of(" \t\r\n");
+
+    return text.substr(first, last - first + 1);
+}
+
+/**
+ * Split a separated list, trimming every item and dropping empty ones
+ */
+inline vector<string> splitList(const string &text, char separator = ',')
+{
+    vector<string> items;
+    size_t begin = 0;
+
+    while (begin <= text.size())
+    {
+        size_t end = text.find(separator, begin);
+
+        if (end == string::npos)
+            end = text.size();
+
+        string item = trim(text.substr(begin, end - begin));
+
+        if (!item.empty())
+            items.push_back(item);
+
+        begin = end + 1;
+    }
+
+    return items;
+}
+
+/**
+ * Split at whitespace, text in double quotes stays one word with the quotes removed
+ */
+inline vector<string> splitWords(const string &text)
+{
+    vector<string> words;
+    string word;
+    bool quoted = false;
+    bool started = false;
+
+    for (char c : text)
+    {
+        if (c == '"')
+        {
+            quoted = !quoted;
+            started = true;
+        }
+        else if (!quoted && (c == ' ' || c == '\t' || c == '\r' || c == '\n'))
+        {
+            if (started)
+                words.push_back(word);
+
+            word.clear();
+            started = false;
+        }
+        else
+        {
+            word += c;
+            started = true;
+        }
+    }
+
+    if (quoted)
+        throw runtime_error("unterminated quote in " + text);
+
+    if (started)
+        words.push_back(word);
+
+    return words;
+}
+
+/**
+ * Read the key = value lines of a config file, # starts a comment
+ */
+inline vector<Setting> readConfigFile(const string &path)
+{
+    ifstream file(path);
+
+    if (!file)
+        throw runtime_error("cannot open config file " + path);
+
+    vector<Setting> settings;
+    string line;
+
+    for (int lineNumber = 1; getline(file, line); ++lineNumber)
+    {
+        line = trim(line.substr(0, line.find('#')));
+
+        if (line.empty())
+            continue;
+
+        const size_t equals = line.find('=');
+
+        if (equals == string::npos)
+            throw runtime_error(path + ":" + to_string(lineNumber) + ": expected key = value");
+
+        settings.push_back({trim(line.substr(0, equals)), trim(line.substr(equals + 1))});
+    }
+
+    return settings;
+}
+
+/**
+ * Settings given as --key value or --key=value, in order
+ * --config file is replaced by the settings of that file, so later arguments override it
+ * --help and --resume may stand alone, without a value
+ */
+inline vector<Setting> parseArguments(int argc, char *argv[])
+{
+    vector<Setting> settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+
+        if (argument.rfind("--", 0) != 0)
+            throw runtime_error("unexpected argument " + argument);
+
+        argument = argument.substr(2);
+
+        Setting setting;
+        const size_t equals = argument.find('=');
+
+        if (equals != string::npos)
+        {
+            setting = {argument.substr(0, equals), argument.substr(equals + 1)};
+        }
+        else if (argument == "help" || argument == "resume")
+        {
+            setting = {argument, ""};
+        }
+        else
+        {
+            if (i + 1 >= argc)
+                throw runtime_error("missing value for --" + argument);
+
+            setting = {argument, argv[++i]};
+        }
+
+        if (setting.key == "config")
+        {
+            vector<Setting> fileSettings = readConfigFile(setting.value);
+            settings.insert(settings.end(), fileSettings.begin(), fileSettings.end());
+        }
+        else
+        {
+            settings.push_back(setting);
+        }
+    }
+
+    return settings;
+}
+
+/**
+ * Parse the whole value of a setting as a number, naming the setting when it is not one
+ */
+template <typename T>
+T parseNumber(const Setting &setting, const string &text)
+{
+    size_t used = 0;
+    T value;
+
+    try
+    {
+        if constexpr (is_floating_point_v<T>)
+            value = stod(text, &used);
+        else if constexpr (is_unsigned_v<T>)
+            value = stoull(text, &used);
+        else
+            value = stoll(text, &used);
+    }
+    catch (const exception &)
+    {
+        used = 0;
+    }
+
+    if (used == 0 || used != text.size())
+        throw runtime_error("invalid value '" + text + "' for " + setting.key);
+
+    return value;
+}
+
+template <typename T>
+T parseNumber(const Setting &setting)
+{
+    return parseNumber<T>(setting, setting.value);
+}
+
+/**
+ * Parse on/off, true/false or 1/0
+ */
+inline bool parseSwitch(const Setting &setting)
+{
+    if (setting.value == "on" || setting.value == "true" || setting.value == "1")
+        return true;
+
+    if (setting.value == "off" || setting.value == "false" || setting.value == "0")
+        return false;
+
+    throw runtime_error("invalid value '" + setting.value + "' for " + setting.key + ", expected on or off");
+}
+
+/**
+ * Parse a comma separated list of numbers
+ */
+template <typename T>
+vector<T> parseNumberList(const Setting &setting)
+{
+    vector<T> values;
+
+    for (const string &item : splitList(setting.value))
+        values.push_back(parseNumber<T>(setting, item));
+
+    if (values.empty())
+        throw runtime_error("empty list for " + setting.key);
+
+    return values;
+}
+
+/**
+ * Find a function or variant by name
+ */
+template <typename T>
+const T &findByName(const vector<T> &items, const string &name, const string &kind)
+{
+    for (const T &item : items)
+    {
+        if (item.name == name)
+            return item;
+    }
+
+    throw runtime_error("unknown " + kind + " " + name);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cmath>
+#include "simd.cpp"
+#include "population.cpp"
+
+using namespace std;
+
+/**
+ * Fireflies per side of a block of the distance matrix, two blocks of 60-dimensional rows fit in L1
+ */
+const int distanceBlock = 16;
+
+/**
+ * Turn what a metric accumulated over the dimensions into its distance
+ * Legacy accumulates the number of exactly equal coordinates, r = 1 - intersect / union,
+ * where the union counts every unequal coordinate twice
+ * Euclidean and squared Euclidean accumulate the squared differences, the squared distance is that sum itself
+ */
+inline double finishDistance(double accumulated, int dim, DistanceMetric metric)
+{
+    if (metric == DistanceMetric::Legacy)
+        return 1.0 - accumulated / (2.0 * dim - accumulated);
+
+    if (metric == DistanceMetric::Euclidean)
+        return sqrt(accumulated);
+
+    return accumulated;
+}
+
+/**
+ * Turn what a metric accumulated into the r² of exp(-gamma * r²), the squared Euclidean distance already is r²
+ */
+inline double finishSquaredDistance(double accumulated, int dim, DistanceMetric metric)
+{
+    const double distance = finishDistance(accumulated, dim, metric);
+
+    if (metric == DistanceMetric::SquaredEuclidean)
+        return distance;
+
+    return distance * distance;
+}
+
+/**
+ * r² between two fireflies stored contiguously, vectorized over the dimensions
+ * Float coordinates are widened as they are loaded, the sum is always accumulated in double
+ */
+template <typename Scalar>
+inline double pairSquaredDistance(const Scalar *a, const Scalar *b, int dim, DistanceMetric metric)
+{
+    const int vectorEnd = dim - dim % SimdDouble::width;
+    SimdDouble sum = 0.0;
+    double tail = 0.0;
+
+    if (metric == DistanceMetric::Legacy)
+    {
+        for (int k = 0; k < vectorEnd; k += SimdDouble::width)
+            sum = sum + equalAsOne(SimdDouble::load(a + k), SimdDouble::load(b + k));
+
+        for (int k = vectorEnd; k < dim; ++k)
+            tail += a[k] == b[k] ? 1.0 : 0.0;
+    }
+    else
+    {
+        for (int k = 0; k < vectorEnd; k += SimdDouble::width)
+        {
+            SimdDouble difference = SimdDouble::load(a + k) - SimdDouble::load(b + k);
+            sum = fma(difference, difference, sum);
+        }
+
+        for (int k = vectorEnd; k < dim; ++k)
+            tail += (double(a[k]) - b[k]) * (double(a[k]) - b[k]);
+    }
+
+    return finishSquaredDistance(reduceAdd(sum) + tail, dim, metric);
+}
+
+/**
+ * r² between firefly a of first and firefly b of second, which may be the same population, returned as Real
+ */
+template <typename Real = double, PopulationLayout Layout, int Dim, typename Scalar>
+inline Real pairSquaredDistance(const Population<Layout, Dim, Scalar> &first, int a, const Population<Layout, Dim, Scalar> &second, int b, DistanceMetric metric)
+{
+    const int dim = first.dimension();
+
+    // AoS rows are contiguous, so the views need no scratch
+    if constexpr (Layout == PopulationLayout::AoS)
+    {
+        return Real(pairSquaredDistance(first.position(a, nullptr).data(), second.position(b, nullptr).data(), dim, metric));
+    }
+    else
+    {
+        double accumulated = 0.0;
+
+        for (int k = 0; k < dim; ++k)
+        {
+            const double difference = double(first(a, k)) - second(b, k);
+
+            if (metric == DistanceMetric::Legacy)
+                accumulated += difference == 0.0 ? 1.0 : 0.0;
+            else
+                accumulated += difference * difference;
+        }
+
+        return Real(finishSquaredDistance(accumulated, dim, metric));
+    }
+}
+
+/**
+ * Block [iBegin, iEnd) x [jBegin, jEnd) of the r² matrix of a population, row i written to out + (i - iBegin) * outStride
+ * AoS pairs are vectorized over the dimensions, SoA over j, since coordinate k of consecutive fireflies is contiguous
+ */
+template <PopulationLayout Layout, int Dim, typename Scalar>
+void squaredDistanceBlock(const Population<Layout, Dim, Scalar> &population, int iBegin, int iEnd, int jBegin, int jEnd, DistanceMetric metric, double *out, size_t outStride)
+{
+    const int dim = population.dimension();
+
+    for (int i = iBegin; i < iEnd; ++i)
+    {
+        double *row = out + (i - iBegin) * outStride;
+        int j = jBegin;
+
+        if constexpr (Layout == PopulationLayout::SoA)
+        {
+            const Scalar *values = population.values.data();
+            const size_t stride = population.stride;
+
+            for (; j + SimdDouble::width <= jEnd; j += SimdDouble::width)
+            {
+                SimdDouble sum = 0.0;
+
+                for (int k = 0; k < dim; ++k)
+                {
+                    const SimdDouble xi = double(values[k * stride + i]);
+                    const SimdDouble xj = SimdDouble::load(&values[k * stride + j]);
+
+                    if (metric == DistanceMetric::Legacy)
+                    {
+                        sum = sum + equalAsOne(xi, xj);
+                    }
+                    else
+                    {
+                        const SimdDouble difference = xi - xj;
+                        sum = fma(difference, difference, sum);
+                    }
+                }
+
+                alignas(64) double lanes[SimdDouble::width];
+                sum.store(lanes);
+
+                for (int l = 0; l < SimdDouble::width; ++l)
+                    row[j - jBegin + l] = finishSquaredDistance(lanes[l], dim, metric);
+            }
+        }
+
+        for (; j < jEnd; ++j)
+            row[j - jBegin] = pairSquaredDistance(population, i, population, j, metric);
+    }
+}
+
+/**
+ * Attractiveness beta0 * exp(-gamma * r²) over a row of r², in place, in one pass the compiler vectorizes
+ */
+inline void attractivenessRow(double *squaredDistance, int count, double beta0, double gamma)
+{
+#pragma omp simd
+    for (int j = 0; j < count; ++j)
+        squaredDistance[j] = beta0 * exp(-gamma * squaredDistance[j]);
+}
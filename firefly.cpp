@@ -10,423 +10,3867 @@
 #include <chrono>
 #include <sstream>
 #include <fstream>
+#include <map>
+#include <bit>
+#include <optional>
 #include "functions.cpp"
 #include "helper_functions.cpp"
 #include "firefly.hpp"
+#include "population.cpp"
+#include "noise.cpp"
+#include "barrier.cpp"
+#include "scheduler.cpp"
+#include "distance.cpp"
+#include "neighbours.cpp"
+#include "config.cpp"
+#include "timing.cpp"
+#include "profile.cpp"
+#include "affinity.cpp"
+#include "island.cpp"
+#include "checkpoint.cpp"
+#include "scaling.cpp"
+#include "service.cpp"
+#include "tuning.cpp"
 
 using namespace std;
 
 /**
- * Firefly Algorithm parameters
+ * Firefly Algorithm parameters, the defaults of the config file and command line settings
  */
-const int populationSize = 50;
-const int maxGenerations = 4000;
+int populationSize = 50;
+int maxGenerations = 4000;
 
-const double attractivenessConstant = 1.0;
-const double absorptionCoefficient = 0.5;
+// beta0 and gamma
+double attractivenessConstant = 1.0;
+double absorptionCoefficient = 0.5;
 
-const double randomnessStart = 0.05;
-const double randomnessEnd = 0.2;
-const double randomnessDelta = (randomnessEnd - randomnessStart) / maxGenerations;
+// alpha, growing linearly from start to end over the generations
+double randomnessStart = 0.05;
+double randomnessEnd = 0.2;
+double randomnessDelta = (randomnessEnd - randomnessStart) / maxGenerations;
 
 /**
  * Other Parameters
  */
-const int numberOfRuns = 30;
-const int minimumThreads = 1;
+int numberOfRuns = 30;
+// Untimed runs before every benchmark, to warm caches, fault in buffers and let clocks settle
+int warmupRuns = 1;
+// Count cycles, instructions, cache and branch misses of the timed runs (Linux perf_event_open)
+bool countHardwareEvents = false;
+PerfCounters hardwareCounters;
+// Where firefly-level threads run, CPU of every thread slot (empty leaves placement to the OS)
+PinPolicy pinPolicy = PinPolicy::None;
+vector<int> pinList;
+vector<int> threadPlacement;
 const int numberOfThreads = omp_get_max_threads();
-const bool isNotPowerOfTwoThreads = isNotPowerOfTwo(numberOfThreads);
 
 /**
- * Table formatting
+ * Island model parameters, used by the variants with a migration topology
  */
-const int nameWidth = 16;
-const int numWidth = 14;
+int islandCount = 4;
+int migrationInterval = 50;
+int migrationSize = 2;
+
+/**
+ * Neighbour-limited variants compare every firefly with neighbourCount others instead of the whole swarm
+ */
+int neighbourCount = 16;
+// Population sizes every function and variant runs with after the sweep, at the largest thread count (empty for none)
+vector<int> neighbourPopulations;
+// Arguments this program was started with, island processes are started with the same ones
+vector<string> programArguments;
+// Shared memory arena and island index when this process is an island of another one's run
+string islandWorker;
+
+/**
+ * Checkpointing of the sweep, finished runs and snapshots of the runs in flight go to checkpointPath
+ * Empty for none, the default, so a plain benchmark does not write the file and flush it after every run
+ */
+string checkpointPath;
+bool resumeSweep = false;
+Checkpoint checkpoint;
+
+/**
+ * Scaling study: after the sweep, every function and variant runs again with the problem growing with the threads
+ */
+bool scalingStudy = false;
+WeakGrowth weakGrowth = WeakGrowth::Population;
+// Parallel efficiency a thread count has to keep to count as scaling
+double efficiencyThreshold = 0.5;
+
+/**
+ * Job service: instead of the sweep, run the jobs read from stdin or a Unix socket ("stdin" or its path, empty for none)
+ */
+string serviceInput;
+// Threads of the pool the jobs share
+int serviceThreads = numberOfThreads;
+// Variant of a job that names none, independent of the variants selected for the sweep
+string serviceVariant = "AoS";
+
+/**
+ * Auto-tuning: instead of the sweep, probe the thread counts, schedules and chunk sizes of every function and variant
+ * with short runs and store the fastest in the profile, which later sweeps and jobs take their settings from
+ */
+bool tuneMode = false;
+// Profile of the tuned settings of every host, empty for none so a plain run does not depend on a file it happens to find
+string tuningPath;
+int tuneGenerations = 50;
+// Timed runs of every probe, after one untimed run
+int tuneRuns = 3;
+vector<LoopSchedule> tuneSchedules = {LoopSchedule::Static, LoopSchedule::Dynamic, LoopSchedule::Guided};
+vector<int> tuneChunks = {1, 4, 16};
+TuningProfile tuningProfile;
+// This machine and build, the part of the profile that applies here
+TuningHost tuningHostKey;
+
+/**
+ * Powers of two up to the number of hardware threads, plus that number when it is not a power of two
+ */
+vector<int> defaultThreadCounts()
+{
+    vector<int> counts;
+
+    for (int threads = 1; threads <= numberOfThreads; threads *= 2)
+        counts.push_back(threads);
+
+    if (isNotPowerOfTwo(numberOfThreads))
+        counts.push_back(numberOfThreads);
+
+    return counts;
+}
+
+/**
+ * Thread counts every benchmark runs with, one table column each
+ */
+vector<int> threadCounts = defaultThreadCounts();
+
+/**
+ * Master seed of all random streams, drawn from the device unless --seed is given
+ */
+uint64_t randomSeed = random_device{}();
+
+// Every function is compiled into the optimizer at its table dimension, by default for the AoS layout in double
+// precision only, since every further layout and precision multiplies the build time. A build with
+// -DFIREFLY_SPECIALIZE_ALL=1 specializes every combination, otherwise the others take the runtime-dimension path.
+#ifndef FIREFLY_SPECIALIZE_ALL
+#define FIREFLY_SPECIALIZE_ALL 0
+#endif
+
+constexpr bool specializeAllInstances = FIREFLY_SPECIALIZE_ALL;
+
+/**
+ * Optimizer specialized for one function at one dimension, defined after the algorithm
+ */
+template <auto Function, auto SingleFunction, int Dim>
+FireflyResult specializedFirefly(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run);
+
+/**
+ * Global minima of the table functions, as functions of the dimension
+ */
+template <double Value>
+optional<double> constantOptimum(int)
+{
+    return Value;
+}
+
+// Functions fixed to one dimension have no known minimum at any other
+optional<double> colvilleOptimum(int dim)
+{
+    return dim == 4 ? optional(0.0) : nullopt;
+}
+
+optional<double> easomOptimum(int dim)
+{
+    return dim == 2 ? optional(-1.0) : nullopt;
+}
+
+optional<double> shekelOptimum(int dim)
+{
+    return dim == 4 ? optional(-10.536443) : nullopt;
+}
+
+optional<double> schwefelOptimum(int dim)
+{
+    return -418.9828872724338 * dim;
+}
+
+// The minimum has no closed form, these are the published values
+optional<double> michalewiczOptimum(int dim)
+{
+    if (dim == 2)
+        return -1.8013034;
+
+    if (dim == 5)
+        return -4.687658;
+
+    if (dim == 10)
+        return -9.66015;
+
+    return nullopt;
+}
+
+/**
+ * Table row for a function, registering its double and float instances, its batch entry point and its specialized optimizer
+ */
+#define FUNCTION_BENCHMARK(dim, min_range, max_range, optimum, name) \
+    {dim, min_range, max_range, optimum, #name, name<double>, name<float>, name##Batch, specializedFirefly<name<double>, name<float>, dim>}
 
 /**
  * Function benchmarks
  */
 const vector<FunctionBenchmark> functionBenchmarks = {
-    {60, -10, 10, "sumSquares", sumSquares},
-    {60, -100, 100, "step2", step2},
-    {60, -1.28, 1.28, "quartic", quartic},
-    {60, -4, 5, "powell", powell},
-    {60, -30, 30, "rosenbrock", rosenbrock},
-    {60, -10, 10, "dixonPrice", dixonPrice},
-    {60, -100, 100, "schwefel1_2", schwefel1_2},
-    {60, -100, 100, "schwefel2_20", schwefel2_20},
-    {60, -100, 100, "schwefel2_21", schwefel2_21},
-    {60, -5.12, 5.12, "rastrigin", rastrigin},
-    {60, -600, 600, "griewank", griewank},
-    {60, -1, 1, "csendes", csendes},
-    {4, -10, 10, "colville", colville},
-    {2, -100, 100, "easom", easom},
-    {5, 0, M_PI, "michalewicz", michalewicz},
-    {4, 0, 10, "shekel", shekel},
-    {60, 0, 10, "schwefel2_4", schwefel2_4},
-    {60, -500, 500, "schwefel", schwefel},
-    {60, -100, 100, "schaffer", schaffer},
-    {30, -10, 10, "alpine", alpine},
-    {30, -32, 32, "ackley", ackley},
-    {30, -5.12, 5.12, "sphere", sphere},
-    {30, -10, 10, "schwefel2_22", schwefel2_22}};
+    FUNCTION_BENCHMARK(60, -10, 10, constantOptimum<0.0>, sumSquares),
+    FUNCTION_BENCHMARK(60, -100, 100, constantOptimum<0.0>, step2),
+    FUNCTION_BENCHMARK(60, -1.28, 1.28, constantOptimum<0.0>, quartic),
+    FUNCTION_BENCHMARK(60, -4, 5, constantOptimum<0.0>, powell),
+    FUNCTION_BENCHMARK(60, -30, 30, constantOptimum<0.0>, rosenbrock),
+    FUNCTION_BENCHMARK(60, -10, 10, constantOptimum<0.0>, dixonPrice),
+    FUNCTION_BENCHMARK(60, -100, 100, constantOptimum<0.0>, schwefel1_2),
+    FUNCTION_BENCHMARK(60, -100, 100, constantOptimum<0.0>, schwefel2_20),
+    FUNCTION_BENCHMARK(60, -100, 100, constantOptimum<0.0>, schwefel2_21),
+    FUNCTION_BENCHMARK(60, -5.12, 5.12, constantOptimum<0.0>, rastrigin),
+    FUNCTION_BENCHMARK(60, -600, 600, constantOptimum<0.0>, griewank),
+    FUNCTION_BENCHMARK(60, -1, 1, constantOptimum<0.0>, csendes),
+    FUNCTION_BENCHMARK(4, -10, 10, colvilleOptimum, colville),
+    FUNCTION_BENCHMARK(2, -100, 100, easomOptimum, easom),
+    FUNCTION_BENCHMARK(5, 0, M_PI, michalewiczOptimum, michalewicz),
+    FUNCTION_BENCHMARK(4, 0, 10, shekelOptimum, shekel),
+    FUNCTION_BENCHMARK(60, 0, 10, constantOptimum<0.0>, schwefel2_4),
+    FUNCTION_BENCHMARK(60, -500, 500, schwefelOptimum, schwefel),
+    FUNCTION_BENCHMARK(60, -100, 100, constantOptimum<0.0>, schaffer),
+    FUNCTION_BENCHMARK(30, -10, 10, constantOptimum<0.0>, alpine),
+    FUNCTION_BENCHMARK(30, -32, 32, constantOptimum<0.0>, ackley),
+    FUNCTION_BENCHMARK(30, -5.12, 5.12, constantOptimum<0.0>, sphere),
+    FUNCTION_BENCHMARK(30, -10, 10, constantOptimum<0.0>, schwefel2_22)};
 
 const int functionCount = functionBenchmarks.size();
 
+/**
+ * Optimizer variants, every function is benchmarked once per variant
+ */
+const vector<Variant> variants = {
+    {"AoS runtime", {.layout = PopulationLayout::AoS, .specialized = false}},
+    {"AoS", {.layout = PopulationLayout::AoS}},
+    {"SoA", {.layout = PopulationLayout::SoA}},
+    {"AoS single", {.layout = PopulationLayout::AoS, .precision = Precision::Single}},
+    {"AoS mixed", {.layout = PopulationLayout::AoS, .precision = Precision::Mixed}},
+    {"SoA single", {.layout = PopulationLayout::SoA, .precision = Precision::Single}},
+    {"SoA mixed", {.layout = PopulationLayout::SoA, .precision = Precision::Mixed}},
+    {"SoA batch", {.layout = PopulationLayout::SoA, .batchEvaluation = true}},
+    {"AoS inline noise", {.layout = PopulationLayout::AoS, .noise = NoiseMode::Inline}},
+    {"AoS inter-run", {.layout = PopulationLayout::AoS, .strategy = ParallelStrategy::InterRun}},
+    {"AoS hybrid", {.layout = PopulationLayout::AoS, .strategy = ParallelStrategy::Hybrid}},
+    {"AoS sync", {.layout = PopulationLayout::AoS, .update = UpdateMode::Synchronous}},
+    {"AoS team spin", {.layout = PopulationLayout::AoS, .team = ThreadTeam::Persistent, .barrierWait = BarrierWait::Spin}},
+    {"AoS team yield", {.layout = PopulationLayout::AoS, .team = ThreadTeam::Persistent, .barrierWait = BarrierWait::SpinYield}},
+    {"AoS team futex", {.layout = PopulationLayout::AoS, .team = ThreadTeam::Persistent, .barrierWait = BarrierWait::Futex}},
+    {"AoS tiled 8", {.layout = PopulationLayout::AoS, .update = UpdateMode::Tiled, .tileSize = 8}},
+    {"AoS tiled 4", {.layout = PopulationLayout::AoS, .update = UpdateMode::Tiled, .tileSize = 4}},
+    {"AoS euclidean", {.layout = PopulationLayout::AoS, .distance = DistanceMetric::Euclidean}},
+    {"AoS sync matrix", {.layout = PopulationLayout::AoS, .update = UpdateMode::Synchronous, .distanceMatrix = true}},
+    {"SoA sync matrix", {.layout = PopulationLayout::SoA, .update = UpdateMode::Synchronous, .distanceMatrix = true}},
+    {"AoS brightest", {.layout = PopulationLayout::AoS, .neighbourhood = Neighbourhood::Brightest}},
+    {"AoS nearest", {.layout = PopulationLayout::AoS, .neighbourhood = Neighbourhood::Nearest}},
+    {"AoS sampled", {.layout = PopulationLayout::AoS, .neighbourhood = Neighbourhood::Sampled}},
+    {"AoS eval per gen", {.layout = PopulationLayout::AoS, .evaluation = EvaluationPolicy::PerGeneration}},
+    {"AoS eval every 4", {.layout = PopulationLayout::AoS, .evaluation = EvaluationPolicy::EveryKMoves, .evaluationInterval = 4}},
+    {"AoS early stop", {.layout = PopulationLayout::AoS, .stopAtTarget = true, .stagnationGenerations = 500}},
+    {"AoS islands ring", {.layout = PopulationLayout::AoS, .topology = MigrationTopology::Ring}},
+    {"AoS islands full", {.layout = PopulationLayout::AoS, .topology = MigrationTopology::Full}},
+    {"AoS island processes", {.layout = PopulationLayout::AoS, .topology = MigrationTopology::Ring, .transport = IslandTransport::Processes}}};
+
+/**
+ * Variants a sweep runs unless the configuration names others: the baseline and the cheap layout and update comparisons.
+ * Island, process, deferred-evaluation and the other specialised variants run only when named.
+ */
+const vector<string> defaultVariantNames = {"AoS runtime", "AoS", "SoA", "AoS sync", "AoS tiled 8"};
+
+vector<Variant> defaultVariants()
+{
+    vector<Variant> selection;
+
+    for (const Variant &variant : variants)
+    {
+        if (find(defaultVariantNames.begin(), defaultVariantNames.end(), variant.name) != defaultVariantNames.end())
+            selection.push_back(variant);
+    }
+
+    return selection;
+}
+
+/**
+ * Functions and variants to benchmark, narrowed and adjusted by the configuration
+ */
+vector<FunctionBenchmark> selectedFunctions = functionBenchmarks;
+vector<Variant> selectedVariants = defaultVariants();
+
+/**
+ * Functions defined for a single dimension, the global dim setting leaves them alone
+ */
+const vector<string> fixedDimensionFunctions = {"colville", "easom", "shekel"};
+
 /**
  * Firefly Algorithm
+ * Objective is any callable taking span<const Real>, Dim fixes the dimension at compile time (0 means func.dim)
+ * Positions and movement noise are stored as Scalar, distances, moves and the objective are computed in Real
  */
-double fireflyAlgorithm(int dim, double min_range, double max_range, function<double(const vector<double> &)> benchmark, int numThreads)
+template <PopulationLayout Layout, int Dim, typename Objective, typename Scalar = double, typename Real = double>
+class FireflySwarm
 {
-    omp_set_num_threads(numThreads);
+    using Positions = Population<Layout, Dim, Scalar>;
+
+public:
+    FireflySwarm(const FunctionBenchmark &func, Objective benchmark, int numThreads, const FireflyOptions &options, int run)
+        : func(func), benchmark(benchmark), numThreads(numThreads), options(options), run(run),
+          dim(Dim > 0 ? Dim : func.dim),
+          min_range(func.min_range),
+          max_range(func.max_range),
+          optimum(func.optimum(dim)),
+          batchEvaluation(options.batchEvaluation && func.batchBenchmark),
+          bulkNoise(options.noise == NoiseMode::Bulk),
+          synchronous(options.update != UpdateMode::InPlace),
+          distanceMatrix(options.distanceMatrix && options.update == UpdateMode::Synchronous && options.neighbourhood == Neighbourhood::All),
+          limitedNeighbours(options.neighbourhood != Neighbourhood::All && options.update != UpdateMode::Tiled),
+          population(populationSize, dim),
+          fitness(populationSize),
+          nextPopulation(synchronous ? populationSize : 0, dim),
+          nextFitness(synchronous ? populationSize : 0),
+          scratchStride(padToCacheLine(dim)),
+          scratch(scratchStride * numThreads),
+          noise(numThreads),
+          batchStride(padToCacheLine(populationSize)),
+          batchInput(batchEvaluation ? batchStride * dim : 0),
+          batchOutput(populationSize),
+          moved(populationSize, false),
+          syncSeconds(numThreads),
+          tileSize(max(options.tileSize, 1)),
+          tileBlocks((populationSize + tileSize - 1) / tileSize),
+          attraction(options.update == UpdateMode::Tiled ? tileBlocks * populationSize * scratchStride : 0),
+          brighterCount(options.update == UpdateMode::Tiled ? tileBlocks * populationSize : 0),
+          scheduler(options.update == UpdateMode::Tiled ? numThreads : 0),
+          matrixStride(padToCacheLine(populationSize)),
+          pairAttractiveness(distanceMatrix ? populationSize * matrixStride : 0),
+          tileStride(padToCacheLine(tileSize)),
+          tileAttractiveness(options.update == UpdateMode::Tiled ? numThreads * tileSize * tileStride : 0),
+          evaluationInterval(options.evaluation == EvaluationPolicy::PerMove ? 1 : options.evaluation == EvaluationPolicy::EveryKMoves ? max(options.evaluationInterval, 1) : numeric_limits<int>::max()),
+          evaluations(numThreads),
+          phases(numThreads),
+          neighbours(limitedNeighbours ? options.neighbourhood : Neighbourhood::All, populationSize, neighbourCount, options.seed, run, numThreads)
+    {
+    }
+
+    FireflyResult optimize()
+    {
+        omp_set_num_threads(numThreads);
+        applySchedule(options.schedule, options.chunkSize);
+
+        startTime = omp_get_wtime();
+        lastSnapshot = startTime;
+
+        if (!restore())
+            initialize();
+
+        if (options.update == UpdateMode::Tiled)
+            evolveTiled();
+        else if (options.team == ThreadTeam::Persistent)
+            evolvePersistentTeam();
+        else
+            evolveForkJoin();
+
+        // Identifying the index of the superior firefly
+        auto min_element_it = min_element(fitness.begin(), fitness.end());
+        int best_index = distance(fitness.begin(), min_element_it);
+
+        return {
+            .bestFitness = fitness[best_index],
+            .rngSeconds = noiseSeconds(),
+            .syncSeconds = waitSeconds(),
+            .scheduler = scheduler.stats(),
+            .evaluations = evaluationCount(),
+            .generations = generationsRun,
+            .target = target,
+            .phases = phaseSeconds(phases),
+            .migrants = migrantsTaken,
+        };
+    }
+
+private:
+    /**
+     * One parallel region per generation, the time threads wait at its closing barrier is the synchronization cost
+     */
+    void evolveForkJoin()
+    {
+        double randomness = firstRandomness;
+
+        for (int gen = firstGeneration; gen < maxGenerations; ++gen)
+        {
+            // Update the randomness value
+            randomness += randomnessDelta;
+
+#pragma omp parallel
+            {
+                pinThread(threadPlacement);
+                PhaseClock clock(threadPhases());
+
+                if (distanceMatrix)
+                {
+                    computeAttractivenessMatrix();
+                    clock.mark(Phase::Distance);
+                }
+
+                if (limitedNeighbours)
+                {
+                    neighbours.rebuild(population, fitness, gen);
+                    clock.mark(Phase::Distance);
+                }
+
+#pragma omp for schedule(runtime) nowait
+                for (int i = 0; i < populationSize; ++i)
+                    moveFirefly(i, gen, randomness, clock);
+
+                double waitStart = omp_get_wtime();
+#pragma omp barrier
+                syncSeconds[omp_get_thread_num()].seconds += omp_get_wtime() - waitStart;
+                clock.mark(Phase::Sync);
+            }
+
+            if (finishGeneration(gen, randomness))
+                break;
+        }
+    }
+
+    /**
+     * One parallel region for the whole run, generations are separated by our own barrier
+     * Fireflies are handed out through an atomic counter, so the team schedules itself like schedule(dynamic)
+     */
+    void evolvePersistentTeam()
+    {
+        SpinBarrier barrier(numThreads, options.barrierWait);
+        atomic<int> nextFirefly{0};
+        atomic<int> nextSlice{0};
+        bool stop = false;
+
+#pragma omp parallel
+        {
+            pinThread(threadPlacement);
+
+            // The barrier has to count the threads actually granted to the team
+#pragma omp single
+            barrier.reset(omp_get_num_threads());
+
+            const int thread = omp_get_thread_num();
+            double randomness = firstRandomness;
+            PhaseClock clock(threadPhases());
+
+            auto synchronize = [&]()
+            {
+                double waitStart = omp_get_wtime();
+                barrier.arriveAndWait();
+                syncSeconds[thread].seconds += omp_get_wtime() - waitStart;
+                clock.mark(Phase::Sync);
+            };
+
+            for (int gen = firstGeneration; gen < maxGenerations; ++gen)
+            {
+                // Every thread tracks the same randomness schedule
+                randomness += randomnessDelta;
+
+                if (distanceMatrix)
+                {
+                    computeAttractivenessMatrix();
+                    clock.mark(Phase::Distance);
+                }
+
+                if (limitedNeighbours)
+                {
+                    neighbours.rebuild(population, fitness, gen);
+                    clock.mark(Phase::Distance);
+                }
+
+                for (int i = nextFirefly.fetch_add(1, memory_order_relaxed); i < populationSize; i = nextFirefly.fetch_add(1, memory_order_relaxed))
+                    moveFirefly(i, gen, randomness, clock);
+
+                synchronize();
+
+                if (batchEvaluation)
+                {
+                    if (thread == 0)
+                        collectPending();
+
+                    synchronize();
+
+                    const int sliceCount = (pending.size() + SimdDouble::width - 1) / SimdDouble::width;
+
+                    for (int slice = nextSlice.fetch_add(1, memory_order_relaxed); slice < sliceCount; slice = nextSlice.fetch_add(1, memory_order_relaxed))
+                        evaluateSlice(slice * SimdDouble::width, clock);
+
+                    synchronize();
+                }
+
+                if (thread == 0)
+                {
+                    pending.clear();
+                    publishGeneration();
+                    nextFirefly.store(0, memory_order_relaxed);
+                    nextSlice.store(0, memory_order_relaxed);
+                    stop = endGeneration(gen, randomness);
+                }
+
+                synchronize();
+
+                // Thread 0 decided before the barrier, so the whole team leaves on the same generation
+                if (stop)
+                    break;
+            }
+        }
+    }
+
+    /**
+     * Synchronous generations over the i x j interaction space, cut into tileSize x tileSize tiles
+     * Tiles are run by the work-stealing scheduler, so the work spreads over more threads than there are fireflies
+     */
+    void evolveTiled()
+    {
+        const int tileCount = tileBlocks * tileBlocks;
+        double randomness = firstRandomness;
+
+        for (int gen = firstGeneration; gen < maxGenerations; ++gen)
+        {
+            // Update the randomness value
+            randomness += randomnessDelta;
+
+#pragma omp parallel
+            {
+                pinThread(threadPlacement);
+                const int thread = omp_get_thread_num();
+                PhaseClock clock(threadPhases());
+
+#pragma omp single
+                scheduler.begin(tileCount, omp_get_num_threads());
+
+                scheduler.deal(thread);
+
+#pragma omp barrier
+                clock.mark(Phase::Sync);
+
+                scheduler.run(thread, [&](int tile)
+                              { accumulateTile(tile / tileBlocks, tile % tileBlocks, clock); });
+
+                double waitStart = omp_get_wtime();
+#pragma omp barrier
+                syncSeconds[thread].seconds += omp_get_wtime() - waitStart;
+                clock.mark(Phase::Sync);
+
+#pragma omp for schedule(dynamic)
+                for (int i = 0; i < populationSize; ++i)
+                    applyDisplacement(i, gen, randomness, clock);
+
+                clock.mark(Phase::Sync);
+            }
+
+            if (finishGeneration(gen, randomness))
+                break;
+        }
+    }
+
+    /**
+     * Sum the pull of the brighter fireflies of column block jb on every firefly of row block ib
+     * Each tile writes its own rows, so tiles need no synchronization between them
+     */
+    void accumulateTile(int ib, int jb, PhaseClock &clock)
+    {
+        const int jBegin = jb * tileSize;
+        const int jEnd = min(jBegin + tileSize, populationSize);
+        const int iBegin = ib * tileSize;
+        const int iEnd = min(iBegin + tileSize, populationSize);
+
+        // Attractiveness of every pair of the tile in one blocked pass
+        double *tile = &tileAttractiveness[omp_get_thread_num() * tileSize * tileStride];
+        squaredDistanceBlock(population, iBegin, iEnd, jBegin, jEnd, options.distance, tile, tileStride);
+
+        for (int i = iBegin; i < iEnd; ++i)
+            attractivenessRow(&tile[(i - iBegin) * tileStride], jEnd - jBegin, attractivenessConstant, absorptionCoefficient);
+
+        clock.mark(Phase::Distance);
+
+        for (int i = iBegin; i < iEnd; ++i)
+        {
+            double *pull = &attraction[(jb * populationSize + i) * scratchStride];
+            int brighter = 0;
+
+            for (int j = jBegin; j < jEnd; ++j)
+            {
+                if (fitness[i] <= fitness[j])
+                    continue;
+
+                if (brighter++ == 0)
+                    fill(pull, pull + dim, 0.0);
+
+                double attractiveness = tile[(i - iBegin) * tileStride + (j - jBegin)];
+
+                for (int k = 0; k < dim; ++k)
+                    pull[k] += attractiveness * (population(j, k) - population(i, k));
+            }
+
+            brighterCount[jb * populationSize + i] = brighter;
+        }
+
+        clock.mark(Phase::Movement);
+    }
+
+    /**
+     * Move firefly i into the next generation and score it if it moved
+     * The pulls are averaged, a plain sum of up to populationSize steps of nearly full length would overshoot,
+     * and the step takes one noise term per generation. Noise summed or averaged over the pairs would grow or shrink
+     * with the number of brighter fireflies, while a sequence of moves of nearly full length keeps about the noise of
+     * its last one.
+     */
+    void applyDisplacement(int i, int gen, double randomness, PhaseClock &clock)
+    {
+        int brighter = 0;
+
+        for (int jb = 0; jb < tileBlocks; ++jb)
+            brighter += brighterCount[jb * populationSize + i];
+
+        nextFitness[i] = fitness[i];
+
+        for (int k = 0; k < dim; ++k)
+            nextPopulation(i, k) = population(i, k);
+
+        if (brighter == 0)
+        {
+            clock.mark(Phase::Movement);
+            return;
+        }
+
+        Real *step = threadScratch();
+        RandomStream stream(options.seed, RandomPurpose::Movement, run, gen, i);
+
+        if (bulkNoise)
+        {
+            NoiseBuffer<Scalar> &threadNoise = noise[omp_get_thread_num()];
+            threadNoise.refill(stream, dim, randomness);
+
+            for (int k = 0; k < dim; ++k)
+                step[k] = threadNoise.values[k];
+        }
+        else
+        {
+            for (int k = 0; k < dim; ++k)
+                step[k] = randomness * centeredDraw(stream, k);
+        }
+
+        for (int jb = 0; jb < tileBlocks; ++jb)
+        {
+            if (brighterCount[jb * populationSize + i] == 0)
+                continue;
+
+            const double *pull = &attraction[(jb * populationSize + i) * scratchStride];
+
+            for (int k = 0; k < dim; ++k)
+                step[k] += pull[k] / brighter;
+        }
+
+        for (int k = 0; k < dim; ++k)
+            nextPopulation(i, k) = min(max(population(i, k) + step[k], min_range), max_range);
+
+        clock.mark(Phase::Movement);
+
+        if (batchEvaluation)
+        {
+            moved[i] = true;
+        }
+        else
+        {
+            nextFitness[i] = score(nextPopulation, i);
+            clock.mark(Phase::Evaluation);
+        }
+    }
+
+    /**
+     * Initialize population and fitness
+     * The population buffers are left untouched at allocation, so here every thread places the fireflies of its static
+     * share, and its own scratch and tile buffers, on its NUMA node
+     */
+    void initialize()
+    {
+#pragma omp parallel
+        {
+            pinThread(threadPlacement);
+            firstTouchThreadBuffers();
+            PhaseClock clock(threadPhases());
+
+#pragma omp for schedule(static)
+            for (int i = 0; i < populationSize; ++i)
+            {
+                if (synchronous)
+                {
+                    for (int j = 0; j < dim; ++j)
+                        nextPopulation(i, j) = 0.0;
+                }
+
+                // Counter-based stream of this firefly, draw j is the same whichever thread runs this iteration
+                RandomStream stream(options.seed, RandomPurpose::Initialization, run, 0, i);
+
+                for (int j = 0; j < dim; ++j)
+                {
+                    // Set position in the search space for each firefly (a vector of random values in a specific range)
+                    population(i, j) = randomDouble(min_range, max_range, stream, j);
+                }
 
-    // Initialize vectors
-    vector<vector<double>> population(populationSize, vector<double>(dim));
-    vector<double> fitness(populationSize);
+                clock.mark(Phase::Init);
 
-    // Initialize population and fitness
-#pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < populationSize; ++i)
+                // Calculate the fitness values for each firefly with its initial position
+                if (!batchEvaluation)
+                {
+                    fitness[i] = score(population, i);
+                    clock.mark(Phase::Evaluation);
+                }
+            }
+        }
+
+        if (batchEvaluation)
+        {
+            for (int i = 0; i < populationSize; ++i)
+                pending.push_back(i);
+
+            evaluatePending();
+        }
+    }
+
+    /**
+     * Move firefly i towards every brighter firefly, or every brighter one of its neighbour list
+     * In-place mode reads and writes the live population, so firefly i may see j half-way through its own move.
+     * Synchronous mode reads the previous generation and writes firefly i into the second buffer.
+     */
+    void moveFirefly(int i, int gen, double randomness, PhaseClock &clock)
     {
-        // Random number generator
-        mt19937 rng(random_device{}() + omp_get_thread_num());
-        // Uniformly distributes those numbers between the specified range
-        // Now each number has the same chance of being chosen
-        uniform_real_distribution<> dist(0.0, 1.0);
+        Positions &self = synchronous ? nextPopulation : population;
+        vector<double> &selfFitness = synchronous ? nextFitness : fitness;
+
+        if (synchronous)
+        {
+            for (int k = 0; k < dim; ++k)
+                self(i, k) = population(i, k);
+
+            selfFitness[i] = fitness[i];
+        }
+
+        // Candidates j of firefly i, c-th of them at neighbourhood[c], or every firefly with j = c
+        const span<const int> neighbourhood = limitedNeighbours ? neighbours.of(i) : span<const int>();
+        const int candidateCount = limitedNeighbours ? neighbourhood.size() : populationSize;
+
+        // Movement noise of firefly i in this generation, the move towards candidate c draws indices c * dim + k
+        RandomStream stream(options.seed, RandomPurpose::Movement, run, gen, i);
+
+        // Noise of one move at a time, generated in one pass and already scaled by the randomness
+        NoiseBuffer<Scalar> &threadNoise = noise[omp_get_thread_num()];
+
+        clock.mark(Phase::Movement);
+
+        // Moves made so far, and how many of them the fitness of firefly i already reflects
+        int moves = 0;
+        int scoredMoves = 0;
+
+        for (int c = 0; c < candidateCount; ++c)
+        {
+            const int j = limitedNeighbours ? neighbourhood[c] : c;
+
+            if (selfFitness[i] > fitness[j])
+            {
+                Real attractiveness;
+
+                if (distanceMatrix)
+                {
+                    // Distance from where firefly i started the generation
+                    attractiveness = pairAttractiveness[i * matrixStride + j];
+                }
+                else
+                {
+                    // Distance from firefly i as it is now to firefly j with the selected metric
+                    Real squaredDistance = pairSquaredDistance<Real>(self, i, population, j, options.distance);
+
+                    // This line calculates the attractiveness of firefly j to firefly i based on their distance r
+                    attractiveness = Real(attractivenessConstant) * exp(Real(-absorptionCoefficient) * squaredDistance);
+                    clock.mark(Phase::Distance);
+                }
+
+                if (bulkNoise)
+                {
+                    // Only the moves actually made draw their noise, the same draws c * dim + k as inline mode
+                    threadNoise.refill(stream, dim, randomness, c * dim);
+                    const Scalar *moveNoise = threadNoise.values.data();
+
+                    // Pure multiply-add over the population and noise arrays
+                    for (int k = 0; k < dim; ++k)
+                    {
+                        Real position = self(i, k) + attractiveness * (population(j, k) - self(i, k)) + moveNoise[k];
+                        self(i, k) = min(max(position, min_range), max_range);
+                    }
+                }
+                else
+                {
+                    for (int k = 0; k < dim; ++k)
+                    {
+                        // Multiplying attractivness with the direction from firefly i to firefly j
+                        // population(j, k) - self(i, k) (distance between the two, if negative firefly i is to the right else j is)
+                        // Then we add the randomness to prevent local optima
+                        Real position = self(i, k) + attractiveness * (population(j, k) - self(i, k)) + randomness * centeredDraw(stream, c * dim + k);
+                        // Ensures that the new position of firefly i in dimension k remains within the specified bounds
+                        self(i, k) = min(max(position, min_range), max_range);
+                    }
+                }
+
+                ++moves;
+                clock.mark(Phase::Movement);
+
+                // Reevalute fitness for firefly i as the policy asks, or leave it for the batch at the end of the generation
+                if (batchEvaluation)
+                {
+                    moved[i] = true;
+                }
+                else if (moves % evaluationInterval == 0)
+                {
+                    selfFitness[i] = score(self, i);
+                    scoredMoves = moves;
+                    clock.mark(Phase::Evaluation);
+                }
+            }
+        }
+
+        // Score the moves the policy skipped, so the next generation compares against where firefly i really is
+        if (!batchEvaluation && moves > scoredMoves)
+        {
+            selfFitness[i] = score(self, i);
+            clock.mark(Phase::Evaluation);
+        }
+    }
+
+    /**
+     * Evaluate and publish the generation the team just moved, then check the stopping criteria
+     * Runs on one thread between parallel regions, returns true when the run should stop
+     */
+    bool finishGeneration(int gen, double randomness)
+    {
+        // Outside the team, where the thread number belongs to an enclosing team of concurrent runs or islands
+        PhaseClock clock(phases[0]);
+
+        collectPending();
+        clock.mark(Phase::Sync);
+
+        // The batch charges its own threads
+        evaluatePending();
+        clock.restart();
+
+        publishGeneration();
+        const bool stop = endGeneration(gen, randomness);
+        clock.mark(Phase::Sync);
+
+        return stop;
+    }
+
+    /**
+     * Record the telemetry of the generation just published, check the stopping criteria and save a snapshot when
+     * the checkpoint interval has passed, randomness is the value the generation moved with
+     * Runs on one thread between generations, returns true when the run should stop
+     */
+    bool endGeneration(int gen, double randomness)
+    {
+        if (options.island)
+            migrate(gen);
+
+        const double best = *min_element(fitness.begin(), fitness.end());
+        const long evaluated = evaluationCount();
+        const double elapsed = omp_get_wtime() - startTime;
+
+        generationsRun = gen + 1;
+
+        if (best < bestSoFar)
+        {
+            bestSoFar = best;
+            stagnantGenerations = 0;
+        }
+        else
+        {
+            stagnantGenerations++;
+        }
+
+        if (!target.hit && optimum && best <= *optimum + options.targetGap)
+            target = {.hit = true, .generation = gen + 1, .evaluations = evaluated, .seconds = elapsed};
+
+        // Islands also stop once any of them reached the target
+        const bool islandsAtTarget = options.island && optimum && options.island->globalBest() <= *optimum + options.targetGap;
+
+        const bool stop = (options.stopAtTarget && (target.hit || islandsAtTarget)) ||
+                          (options.stagnationGenerations > 0 && stagnantGenerations >= options.stagnationGenerations) ||
+                          (options.timeBudgetSeconds > 0.0 && elapsed >= options.timeBudgetSeconds) ||
+                          (options.evaluationBudget > 0 && evaluated >= options.evaluationBudget);
+
+        // A run that stops is recorded whole by the benchmark, the snapshot is for runs cut short
+        if (!stop && options.checkpoint && omp_get_wtime() - lastSnapshot >= options.checkpoint->interval)
+            saveSnapshot(gen, randomness);
+
+        return stop;
+    }
+
+    /**
+     * Copy the state after generation gen into the checkpoint, everything restore() needs to go on with gen + 1
+     */
+    void saveSnapshot(int gen, double randomness)
+    {
+        Checkpoint &checkpoint = *options.checkpoint;
+        RunSnapshot *slot = checkpoint.beginSnapshot(run);
+        double *values = Checkpoint::snapshotValues(slot);
+
+        for (int i = 0; i < populationSize; ++i)
+        {
+            for (int k = 0; k < dim; ++k)
+                values[i * dim + k] = population(i, k);
+
+            values[populationSize * dim + i] = fitness[i];
+        }
+
+        slot->generation = gen + 1;
+        slot->randomness = randomness;
+        slot->elapsedSeconds = omp_get_wtime() - startTime;
+        slot->bestSoFar = bestSoFar;
+        slot->stagnantGenerations = stagnantGenerations;
+        slot->evaluations = evaluationCount();
+        slot->rngSeconds = noiseSeconds();
+        slot->syncSeconds = waitSeconds();
+        slot->target = target;
+        slot->migrants = migrantsTaken;
+
+        checkpoint.endSnapshot(run, slot);
+        lastSnapshot = omp_get_wtime();
+    }
+
+    /**
+     * Continue from the latest snapshot of this run instead of a fresh population, false when there is none
+     * The random streams are keyed by generation, so the run goes on drawing exactly what it would have drawn.
+     * Like initialize(), every thread copies in and first-touches the fireflies of its static share.
+     */
+    bool restore()
+    {
+        const RunSnapshot *snapshot = options.checkpoint ? options.checkpoint->snapshot(run) : nullptr;
+
+        if (!snapshot)
+            return false;
+
+        const double *values = Checkpoint::snapshotValues(snapshot);
+
+#pragma omp parallel
+        {
+            pinThread(threadPlacement);
+            firstTouchThreadBuffers();
+
+#pragma omp for schedule(static)
+            for (int i = 0; i < populationSize; ++i)
+            {
+                for (int k = 0; k < dim; ++k)
+                {
+                    population(i, k) = values[i * dim + k];
+
+                    if (synchronous)
+                        nextPopulation(i, k) = 0.0;
+                }
+
+                fitness[i] = values[populationSize * dim + i];
+            }
+        }
+
+        firstGeneration = snapshot->generation;
+        firstRandomness = snapshot->randomness;
+        generationsRun = snapshot->generation;
+        bestSoFar = snapshot->bestSoFar;
+        stagnantGenerations = snapshot->stagnantGenerations;
+        target = snapshot->target;
+        migrantsTaken = snapshot->migrants;
+
+        // The totals so far are carried by thread 0, the sums over threads stay right
+        evaluations[0].count = snapshot->evaluations;
+        noise[0].seconds = snapshot->rngSeconds;
+        syncSeconds[0].seconds = snapshot->syncSeconds;
+
+        // Time limits and time to target count the time before the snapshot as well
+        startTime = omp_get_wtime() - snapshot->elapsedSeconds;
+        lastSnapshot = omp_get_wtime();
+
+        return true;
+    }
+
+    /**
+     * Publish the best fitness of the island, and every migration interval send its best fireflies to the islands
+     * of the topology and let the fireflies that arrived replace the worst ones they beat
+     */
+    void migrate(int gen)
+    {
+        IslandLink &link = *options.island;
+        link.offerBest(*min_element(fitness.begin(), fitness.end()));
+
+        if ((gen + 1) % link.interval() != 0)
+            return;
+
+        vector<int> order(populationSize);
+        iota(order.begin(), order.end(), 0);
+
+        const int migrants = min(link.migrants(), populationSize);
+        partial_sort(order.begin(), order.begin() + migrants, order.end(), [&](int a, int b)
+                     { return fitness[a] < fitness[b]; });
+
+        // Migrants travel as doubles whatever the precision of the islands
+        vector<double> position(dim);
+
+        for (int m = 0; m < migrants; ++m)
+            link.send(population.positionAs(order[m], position.data()), fitness[order[m]]);
+
+        link.receive([&](span<const double> position, double migrantFitness)
+                     {
+                         const int worst = distance(fitness.begin(), max_element(fitness.begin(), fitness.end()));
+
+                         if (migrantFitness >= fitness[worst])
+                             return;
+
+                         for (int k = 0; k < dim; ++k)
+                             population(worst, k) = position[k];
+
+                         fitness[worst] = migrantFitness;
+                         migrantsTaken++; });
+    }
+
+    double noiseSeconds() const
+    {
+        double total = 0.0;
+
+        for (const NoiseBuffer<Scalar> &buffer : noise)
+            total += buffer.seconds;
+
+        return total;
+    }
+
+    double waitSeconds() const
+    {
+        double total = 0.0;
+
+        for (const ThreadSeconds &thread : syncSeconds)
+            total += thread.seconds;
+
+        return total;
+    }
+
+    long evaluationCount() const
+    {
+        long total = 0;
+
+        for (const ThreadCounter &thread : evaluations)
+            total += thread.count;
+
+        return total;
+    }
+
+    /**
+     * Evaluate firefly i of a population and count the evaluation
+     */
+    double score(const Positions &source, int i)
+    {
+        evaluations[omp_get_thread_num()].count++;
+
+        return benchmark(source.positionAs(i, threadScratch()));
+    }
+
+    /**
+     * Attractiveness of every pair of the current generation, computed in distanceBlock x distanceBlock blocks
+     * Called by every thread of the team, the blocks are shared out by an orphaned omp for
+     */
+    void computeAttractivenessMatrix()
+    {
+        const int blocks = (populationSize + distanceBlock - 1) / distanceBlock;
+
+#pragma omp for schedule(dynamic)
+        for (int block = 0; block < blocks * blocks; ++block)
+        {
+            const int iBegin = block / blocks * distanceBlock;
+            const int jBegin = block % blocks * distanceBlock;
+            const int iEnd = min(iBegin + distanceBlock, populationSize);
+            const int jEnd = min(jBegin + distanceBlock, populationSize);
+            double *out = &pairAttractiveness[iBegin * matrixStride + jBegin];
+
+            squaredDistanceBlock(population, iBegin, iEnd, jBegin, jEnd, options.distance, out, matrixStride);
+
+            for (int i = iBegin; i < iEnd; ++i)
+                attractivenessRow(&out[(i - iBegin) * matrixStride], jEnd - jBegin, attractivenessConstant, absorptionCoefficient);
+        }
+    }
+
+    /**
+     * Queue the fireflies that moved this generation for the batch
+     */
+    void collectPending()
+    {
+        if (!batchEvaluation)
+            return;
+
+        for (int i = 0; i < populationSize; ++i)
+        {
+            if (moved[i])
+                pending.push_back(i);
+
+            moved[i] = false;
+        }
+    }
+
+    /**
+     * Score every pending firefly, one SIMD-width slice of candidates per task
+     */
+    void evaluatePending()
+    {
+        const int count = pending.size();
+
+#pragma omp parallel
+        {
+            pinThread(threadPlacement);
+            PhaseClock clock(threadPhases());
+
+#pragma omp for schedule(dynamic)
+            for (int begin = 0; begin < count; begin += SimdDouble::width)
+                evaluateSlice(begin, clock);
+        }
+
+        pending.clear();
+    }
+
+    /**
+     * Score the pending fireflies from index begin, one SIMD width of them
+     * They are read from the buffer the generation was written to
+     */
+    void evaluateSlice(int begin, PhaseClock &clock)
+    {
+        const Positions &candidates = synchronous ? nextPopulation : population;
+        vector<double> &candidateFitness = synchronous ? nextFitness : fitness;
+        const int sliceCount = min<int>(SimdDouble::width, pending.size() - begin);
+
+        for (int k = 0; k < dim; ++k)
+            for (int c = begin; c < begin + sliceCount; ++c)
+                batchInput[k * batchStride + c] = candidates(pending[c], k);
+
+        func.batchBenchmark(&batchInput[begin], batchStride, sliceCount, dim, &batchOutput[begin]);
+        evaluations[omp_get_thread_num()].count += sliceCount;
+
+        for (int c = begin; c < begin + sliceCount; ++c)
+            candidateFitness[pending[c]] = batchOutput[c];
+
+        clock.mark(Phase::Evaluation);
+    }
+
+    /**
+     * Make the generation just computed the current one
+     */
+    void publishGeneration()
+    {
+        if (synchronous)
+        {
+            swap(population, nextPopulation);
+            swap(fitness, nextFitness);
+        }
+    }
+
+    /**
+     * Draw index of a movement stream minus 0.5, from the float stream when the noise buffers hold floats,
+     * so inline noise draws what bulk noise would
+     */
+    Real centeredDraw(const RandomStream &stream, uint64_t index) const
+    {
+        if constexpr (is_same_v<Scalar, float>)
+            return stream.uniformFloat(index) - 0.5f;
+        else
+            return randomDouble(0, 1, stream, index) - 0.5;
+    }
+
+    /**
+     * Buffer for gathering a firefly that is not stored contiguously or not as Real, one per thread
+     */
+    Real *threadScratch()
+    {
+        return &scratch[omp_get_thread_num() * scratchStride];
+    }
+
+    /**
+     * Zero the scratch and tile buffers of the calling thread, so their pages land on its node
+     */
+    void firstTouchThreadBuffers()
+    {
+        const int thread = omp_get_thread_num();
+
+        fill_n(&scratch[thread * scratchStride], scratchStride, 0.0);
+
+        if (!tileAttractiveness.empty())
+            fill_n(&tileAttractiveness[thread * tileSize * tileStride], tileSize * tileStride, 0.0);
+    }
+
+    ThreadPhases &threadPhases()
+    {
+        return phases[omp_get_thread_num()];
+    }
+
+    const FunctionBenchmark &func;
+    Objective benchmark;
+    const int numThreads;
+    const FireflyOptions &options;
+    const int run;
+
+    const int dim;
+    const Real min_range;
+    const Real max_range;
+    // Of the function at the dimension of the run, without one no run reaches a target
+    const optional<double> optimum;
+    const bool batchEvaluation;
+    const bool bulkNoise;
+    const bool synchronous;
+    const bool distanceMatrix;
+    const bool limitedNeighbours;
+
+    // Flat population matrix and fitness, plus the buffers synchronous mode writes the next generation into
+    Positions population;
+    vector<double> fitness;
+    Positions nextPopulation;
+    vector<double> nextFitness;
+
+    const size_t scratchStride;
+    FirstTouchVector<Real> scratch;
+
+    // Per-thread movement noise, one value per (j, k) pair of the firefly being moved
+    vector<NoiseBuffer<Scalar>> noise;
+
+    // Dimension-major staging buffer and the fireflies waiting for a batched evaluation
+    const size_t batchStride;
+    AlignedVector<double> batchInput;
+    vector<double> batchOutput;
+    vector<int> pending;
+    vector<char> moved;
+
+    // Time each thread spent waiting for the others at the end of a generation
+    vector<ThreadSeconds> syncSeconds;
+
+    // Tiled mode: pull of column block jb on firefly i at row jb * populationSize + i,
+    // how many fireflies of the block are brighter, and the scheduler running the tiles
+    const int tileSize;
+    const int tileBlocks;
+    AlignedVector<double> attraction;
+    vector<int> brighterCount;
+    WorkStealingScheduler scheduler;
+
+    // Attractiveness matrix of the generation (row i at i * matrixStride), and per-thread blocks of it for the tiles
+    const size_t matrixStride;
+    AlignedVector<double> pairAttractiveness;
+    const size_t tileStride;
+    FirstTouchVector<double> tileAttractiveness;
+
+    // Moves between evaluations of a moving firefly (a per-generation policy never reaches it), and evaluations per thread
+    const int evaluationInterval;
+    vector<ThreadCounter> evaluations;
+
+    // Time every thread spent in each phase of the run
+    vector<ThreadPhases> phases;
+
+    // Neighbour lists of the generation when fireflies are only compared with a bounded set
+    NeighbourLists neighbours;
+
+    // Where the generation loop starts, after the generation of the snapshot a resumed run continues from
+    int firstGeneration = 0;
+    double firstRandomness = randomnessStart;
+
+    // Run telemetry and stopping state, only touched between generations
+    double startTime = 0.0;
+    double lastSnapshot = 0.0;
+    int generationsRun = 0;
+    double bestSoFar = numeric_limits<double>::infinity();
+    int stagnantGenerations = 0;
+    TargetTelemetry target;
+    long migrantsTaken = 0;
+};
+
+template <PopulationLayout Layout, int Dim, typename Scalar, typename Real, typename Objective>
+FireflyResult fireflyAlgorithmImpl(const FunctionBenchmark &func, Objective benchmark, int numThreads, const FireflyOptions &options, int run)
+{
+    return FireflySwarm<Layout, Dim, Objective, Scalar, Real>(func, benchmark, numThreads, options, run).optimize();
+}
+
+template <PopulationLayout Layout, int Dim, typename Objective, typename SingleObjective>
+FireflyResult precisionFirefly(const FunctionBenchmark &func, Objective benchmark, SingleObjective singleBenchmark, int numThreads, const FireflyOptions &options, int run)
+{
+    if (options.precision == Precision::Single)
+        return fireflyAlgorithmImpl<Layout, Dim, float, float>(func, singleBenchmark, numThreads, options, run);
+
+    if (options.precision == Precision::Mixed)
+        return fireflyAlgorithmImpl<Layout, Dim, float, double>(func, benchmark, numThreads, options, run);
+
+    return fireflyAlgorithmImpl<Layout, Dim, double, double>(func, benchmark, numThreads, options, run);
+}
+
+/**
+ * Run the swarm in the layout and precision of the options, single precision evaluates the float instance
+ */
+template <int Dim, typename Objective, typename SingleObjective>
+FireflyResult layoutFirefly(const FunctionBenchmark &func, Objective benchmark, SingleObjective singleBenchmark, int numThreads, const FireflyOptions &options, int run)
+{
+    if (options.layout == PopulationLayout::SoA)
+        return precisionFirefly<PopulationLayout::SoA, Dim>(func, benchmark, singleBenchmark, numThreads, options, run);
+
+    return precisionFirefly<PopulationLayout::AoS, Dim>(func, benchmark, singleBenchmark, numThreads, options, run);
+}
+
+/**
+ * Run the Firefly Algorithm through std::function with the dimension known only at runtime
+ * This is the fallback for ad-hoc functions and for dimensions without a specialized instance
+ */
+FireflyResult runtimeFirefly(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run)
+{
+    return layoutFirefly<0>(func, cref(func.benchmark), cref(func.singleBenchmark), numThreads, options, run);
+}
+
+/**
+ * Calls a benchmark function directly so the compiler can inline it into the optimizer
+ */
+template <auto Function>
+struct StaticObjective
+{
+    template <typename T>
+    T operator()(span<const T> x) const
+    {
+        return Function(x);
+    }
+};
+
+/**
+ * Whether the specialized instances cover the layout and precision of the options, or they take the runtime-dimension path
+ */
+bool specializedInstance(const FireflyOptions &options)
+{
+    return specializeAllInstances || (options.layout == PopulationLayout::AoS && options.precision == Precision::Double);
+}
+
+/**
+ * Whether the variant of the options runs in a specialized instance at the table dimension of a function
+ */
+bool specializedPath(const FireflyOptions &options)
+{
+    return options.specialized && specializedInstance(options);
+}
+
+template <auto Function, auto SingleFunction, int Dim>
+FireflyResult specializedFirefly(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run)
+{
+    if (func.dim != Dim || !specializedInstance(options))
+        return runtimeFirefly(func, numThreads, options, run);
+
+    if constexpr (specializeAllInstances)
+        return layoutFirefly<Dim>(func, StaticObjective<Function>(), StaticObjective<SingleFunction>(), numThreads, options, run);
+    else
+        return fireflyAlgorithmImpl<PopulationLayout::AoS, Dim, double, double>(func, StaticObjective<Function>(), numThreads, options, run);
+}
+
+FireflyResult islandFirefly(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run);
+
+/**
+ * Run the Firefly Algorithm, through the specialized instance when there is one
+ */
+FireflyResult fireflyAlgorithm(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run)
+{
+    if (options.topology != MigrationTopology::None && !options.island)
+        return islandFirefly(func, numThreads, options, run);
+
+    if (options.specialized && func.specialized)
+        return func.specialized(func, numThreads, options, run);
+
+    return runtimeFirefly(func, numThreads, options, run);
+}
+
+/**
+ * Islands as worker processes, each a copy of this program started with the same settings plus the arena to join
+ */
+vector<IslandReport> runIslandProcesses(const FunctionBenchmark &func, const IslandShape &shape, int islandThreads, const FireflyOptions &options, int run)
+{
+#ifdef __linux__
+    static atomic<int> arenaCount{0};
+    const string name = "/firefly-" + to_string(getpid()) + "-" + to_string(arenaCount++);
+
+    IslandArena arena(name, &shape);
+    IslandHeader &header = arena.header();
+
+    strncpy(header.function, func.name.c_str(), sizeof(header.function) - 1);
+    header.options = options;
+    header.threads = islandThreads;
+    header.run = run;
+    header.objectiveSeed = objectiveSeed;
+
+    vector<pid_t> workers;
+
+    for (int island = 0; island < shape.islands; ++island)
+    {
+        vector<string> arguments = programArguments;
+        arguments.push_back("--island.worker");
+        arguments.push_back(name + "," + to_string(island));
+        workers.push_back(spawnSelf(arguments));
+    }
+
+    int failed = 0;
+
+    for (pid_t worker : workers)
+        failed += waitForProcess(worker) ? 0 : 1;
+
+    if (failed > 0)
+        throw runtime_error(to_string(failed) + " island processes failed");
+
+    vector<IslandReport> reports(shape.islands);
+
+    for (int island = 0; island < shape.islands; ++island)
+        reports[island] = arena.report(island);
+
+    return reports;
+#else
+    throw runtime_error("island processes need Linux, use the thread islands");
+#endif
+}
+
+/**
+ * Island model: islandCount swarms of populationSize fireflies splitting the thread budget, as threads or processes
+ * The result is the best island, with the evaluations of all islands and the first island to reach the target
+ */
+FireflyResult islandFirefly(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run)
+{
+    const IslandShape shape{.islands = islandCount, .dim = func.dim, .migrants = migrationSize, .interval = migrationInterval, .topology = options.topology};
+    const int islandThreads = max(1, numThreads / islandCount);
+    vector<IslandReport> reports(islandCount);
+
+    // Island runs are checkpointed once finished, the islands themselves keep no snapshots
+    FireflyOptions swarmOptions = options;
+    swarmOptions.checkpoint = nullptr;
+
+    if (options.transport == IslandTransport::Processes)
+    {
+        reports = runIslandProcesses(func, shape, islandThreads, swarmOptions, run);
+    }
+    else
+    {
+        IslandArena arena(shape);
+
+#pragma omp parallel for num_threads(islandCount) schedule(static)
+        for (int island = 0; island < islandCount; ++island)
+        {
+            IslandLink link(arena, island);
+            FireflyOptions islandOptions = swarmOptions;
+            islandOptions.island = &link;
+            islandOptions.seed = islandSeed(swarmOptions.seed, island);
+
+            reports[island] = islandReport(fireflyAlgorithm(func, islandThreads, islandOptions, run));
+        }
+    }
+
+    FireflyResult result{};
+    result.bestFitness = numeric_limits<double>::max();
+
+    for (const IslandReport &report : reports)
+    {
+        result.bestFitness = min(result.bestFitness, report.bestFitness);
+        result.rngSeconds += report.rngSeconds;
+        result.syncSeconds += report.syncSeconds;
+        result.evaluations += report.evaluations;
+        result.generations = max(result.generations, report.generations);
+        result.migrants += report.migrants;
+
+        if (report.target.hit && (!result.target.hit || report.target.seconds < result.target.seconds))
+            result.target = report.target;
+    }
+
+    return result;
+}
+
+/**
+ * Whether a hybrid variant has too few threads for two groups of hybridFireflyThreads, and so runs as intra-run
+ */
+bool hybridDegenerates(const FireflyOptions &options, int threads)
+{
+    return options.strategy == ParallelStrategy::Hybrid && threads < 2 * max(options.hybridFireflyThreads, 1);
+}
+
+/**
+ * Name the thread counts hybrid variants ran as intra-run at, so those cells are not read as hybrid results
+ */
+void printHybridNotes()
+{
+    for (const Variant &variant : selectedVariants)
+    {
+        string counts;
+
+        for (int threads : threadCounts)
+        {
+            if (hybridDegenerates(variant.options, threads))
+                counts += (counts.empty() ? "" : ", ") + to_string(threads);
+        }
+
+        if (!counts.empty())
+            cout << "Note: " << variant.name << " runs as intra-run at " << counts << " threads, too few for two groups of "
+                 << variant.options.hybridFireflyThreads << endl;
+    }
+}
+
+/**
+ * Whether a variant scores its fireflies later than after every move, so they compare against stale brightness
+ * and its results are those of a different algorithm than the per-move variants
+ */
+bool deferredEvaluation(const FireflyOptions &options)
+{
+    return options.batchEvaluation || options.evaluation != EvaluationPolicy::PerMove;
+}
+
+/**
+ * Name the deferred-evaluation variants, so their times are not read as a faster way to the same results
+ */
+void printDeferredNotes()
+{
+    for (const Variant &variant : selectedVariants)
+    {
+        if (deferredEvaluation(variant.options))
+            cout << "Note: " << variant.name << " defers evaluation, its fireflies compare against stale brightness"
+                 << " and converge more slowly than with per-move evaluation, see the deferred evaluation tables" << endl;
+    }
+}
+
+/**
+ * Settings the tuner stored for a function and variant on this host, if any
+ */
+optional<TunedSetting> tunedSetting(const FunctionBenchmark &func, const Variant &variant)
+{
+    return tuningProfile.find(tuningHostKey, func.name, variant.name);
+}
+
+/**
+ * Execute the benchmark for a specific function and number of threads, cell is its index in the sweep (-1 for none)
+ * With a checkpoint, runs it recorded are taken from it and the others recorded as they finish, so a benchmark
+ * the checkpoint holds whole runs nothing
+ */
+Benchmark executeBenchmark(const FunctionBenchmark &func, const Variant &variant, int threads, int cell)
+{
+    vector<double> results(numberOfRuns);
+    double rngSeconds = 0.0;
+    double syncSeconds = 0.0;
+    long evaluations = 0;
+    long generations = 0;
+    long migrants = 0;
+    int executedRuns = 0;
+    double restoredSeconds = 0.0;
+    // Generations times firefly-level threads summed over the runs, stopping criteria and unequal hybrid groups make them differ
+    long threadGenerations = 0;
+    int targetHits = 0;
+    double targetSeconds = 0.0;
+    double targetEvaluations = 0.0;
+    vector<SchedulerStats> schedulerStats;
+    vector<PhaseTimes> phaseTimes;
+
+    FireflyOptions options = variant.options;
+    options.seed = randomSeed;
+
+    // The thread count is the column's, the loop schedule the one tuned for this host
+    if (const optional<TunedSetting> tuned = tunedSetting(func, variant))
+    {
+        options.schedule = tuned->schedule;
+        options.chunkSize = tuned->chunkSize;
+    }
+
+    const bool checkpointed = checkpoint.enabled() && cell >= 0;
+    FireflyOptions warmupOptions = options;
+
+    if (checkpointed)
+    {
+        checkpoint.beginCell(cell);
+        options.checkpoint = &checkpoint;
+    }
+
+    const bool recorded = checkpointed && checkpoint.cell(cell).state == 2;
+
+    // Split the thread budget into concurrent runs times firefly-level threads per run
+    int runThreads = 1;
+    int fireflyThreads = threads;
+    // Hybrid groups given one thread more than fireflyThreads, so the remainder of the budget does not sit idle
+    int widerGroups = 0;
+
+    if (options.strategy == ParallelStrategy::InterRun)
+    {
+        runThreads = threads;
+        fireflyThreads = 1;
+    }
+    else if (options.strategy == ParallelStrategy::Hybrid)
+    {
+        runThreads = max(threads / max(options.hybridFireflyThreads, 1), 1);
+        fireflyThreads = threads / runThreads;
+        widerGroups = threads % runThreads;
+    }
+
+    // Firefly-level threads of the group a run executes in, the outer thread number is the group
+    auto groupThreads = [&]()
+    {
+        return fireflyThreads + (omp_get_thread_num() < widerGroups ? 1 : 0);
+    };
+
+    // Runs, and thread islands, executing concurrently each open their own firefly-level team, so an island variant
+    // run by concurrent runs nests three teams deep
+    const bool islandTeams = options.topology != MigrationTopology::None && options.transport == IslandTransport::Threads;
+    const int levels = (runThreads > 1 ? 1 : 0) + (islandTeams ? 1 : 0) + (fireflyThreads > 1 || widerGroups > 0 ? 1 : 0);
+    omp_set_max_active_levels(max(levels, 1));
+
+#pragma omp parallel for num_threads(runThreads) schedule(dynamic)
+    for (int run = 0; run < (recorded ? 0 : warmupRuns); ++run)
+        fireflyAlgorithm(func, groupThreads(), warmupOptions, run);
+
+    // A run's sample is its wall time divided by the runs executing at once, so samples of every strategy measure throughput
+    vector<double> samples(numberOfRuns);
+    const int concurrentRuns = min(runThreads, numberOfRuns);
+
+    const double cpuStart = processCpuSeconds();
+    const HardwareCounters countersStart = hardwareCounters.read();
+    auto start = chrono::high_resolution_clock::now();
+
+    // Run the Firefly Algorithm multiple times
+#pragma omp parallel for num_threads(runThreads) schedule(dynamic) reduction(+ : rngSeconds, syncSeconds, evaluations, generations, targetHits, targetSeconds, targetEvaluations, migrants, executedRuns, restoredSeconds, threadGenerations)
+    for (int run = 0; run < numberOfRuns; ++run)
+    {
+        FireflyResult result;
+
+        if (checkpointed && checkpoint.finishedRun(run, result, samples[run]))
+        {
+            restoredSeconds += samples[run];
+        }
+        else
+        {
+            // A run resumed from a snapshot also counts the time it ran before it
+            const RunSnapshot *snapshot = checkpointed ? checkpoint.snapshot(run) : nullptr;
+            const double runStart = omp_get_wtime() - (snapshot ? snapshot->elapsedSeconds : 0.0);
+            result = fireflyAlgorithm(func, groupThreads(), options, run);
+            samples[run] = (omp_get_wtime() - runStart) / concurrentRuns;
+            executedRuns++;
+
+            if (checkpointed)
+                checkpoint.finishRun(run, result, samples[run]);
+        }
+
+        results[run] = result.bestFitness;
+        threadGenerations += (long)groupThreads() * result.generations;
+        rngSeconds += result.rngSeconds;
+        syncSeconds += result.syncSeconds;
+        evaluations += result.evaluations;
+        generations += result.generations;
+        migrants += result.migrants;
+
+        if (result.target.hit)
+        {
+            targetHits++;
+            targetSeconds += result.target.seconds;
+            targetEvaluations += result.target.evaluations;
+        }
+
+#pragma omp critical
+        {
+            schedulerStats.resize(max(schedulerStats.size(), result.scheduler.size()));
+
+            for (size_t thread = 0; thread < result.scheduler.size(); ++thread)
+            {
+                schedulerStats[thread].tiles += result.scheduler[thread].tiles;
+                schedulerStats[thread].steals += result.scheduler[thread].steals;
+                schedulerStats[thread].idleSeconds += result.scheduler[thread].idleSeconds;
+            }
+
+            phaseTimes.resize(max(phaseTimes.size(), result.phases.size()));
+
+            for (size_t thread = 0; thread < result.phases.size(); ++thread)
+            {
+                for (int phase = 0; phase < phaseCount; ++phase)
+                    phaseTimes[thread][phase] += result.phases[thread][phase] / numberOfRuns;
+            }
+        }
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+
+    // Runs taken from the checkpoint add their samples to the wall time, CPU time and events are per executed run
+    double elapsedSeconds = chrono::duration<double>(end - start).count() + restoredSeconds;
+    double cpuSeconds = executedRuns > 0 ? (processCpuSeconds() - cpuStart) / executedRuns : 0.0;
+    HardwareCounters counters = executedRuns > 0 ? countersBetween(countersStart, hardwareCounters.read(), executedRuns) : HardwareCounters{};
+
+    if (recorded)
+    {
+        const CellRecord &record = checkpoint.cell(cell);
+        elapsedSeconds = record.elapsedSeconds;
+        cpuSeconds = record.cpuSeconds;
+        counters = record.counters;
+    }
+    else if (checkpointed)
+    {
+        checkpoint.finishCell(elapsedSeconds, cpuSeconds, counters);
+    }
+
+    chrono::duration<double> elapsed(elapsedSeconds);
+
+    Benchmark bench{
+        .threadCount = threads,
+        .functionName = func.name,
+        .variantName = variant.name,
+        .time = elapsed / numberOfRuns,
+        .rngTime = chrono::duration<double>(rngSeconds / numberOfRuns),
+        .syncTime = chrono::duration<double>(syncSeconds / max(threadGenerations, 1L)),
+        .scheduler = schedulerStats,
+        .evaluations = (double)evaluations / numberOfRuns,
+        .generations = (double)generations / numberOfRuns,
+        .targetHits = targetHits,
+        .timeToTarget = chrono::duration<double>(targetHits > 0 ? targetSeconds / targetHits : NAN),
+        .evaluationsToTarget = targetHits > 0 ? targetEvaluations / targetHits : NAN,
+        .averageResult = calculateAverage(results),
+        .bestResult = *min_element(results.begin(), results.end()),
+        .samples = samples,
+        .results = results,
+        .timing = summarize(samples),
+        .cpuTime = chrono::duration<double>(cpuSeconds),
+        .phases = phaseTimes,
+        .counters = counters,
+        .migrants = (double)migrants / numberOfRuns,
+    };
+
+    return bench;
+}
+
+/**
+ * Problem size of every thread count of a weak scaling row, relative to the configured population and dimension
+ */
+vector<WeakSize> weakSizes(const FunctionBenchmark &func)
+{
+    const bool fixedDimension = find(fixedDimensionFunctions.begin(), fixedDimensionFunctions.end(), func.name) != fixedDimensionFunctions.end();
+    vector<WeakSize> sizes;
+
+    for (int threads : threadCounts)
+        sizes.push_back(weakSize(populationSize, func.dim, (double)threads / threadCounts[0], weakGrowth, fixedDimension));
+
+    return sizes;
+}
+
+/**
+ * Keeps the configured populationSize of the scope it lives in, whatever size the scope runs benchmarks at,
+ * and restores it when the scope ends, also when a benchmark throws
+ */
+class PopulationScope
+{
+public:
+    PopulationScope() : configured(populationSize)
+    {
+    }
+
+    ~PopulationScope()
+    {
+        populationSize = configured;
+    }
+
+    PopulationScope(const PopulationScope &) = delete;
+    PopulationScope &operator=(const PopulationScope &) = delete;
+
+private:
+    const int configured;
+};
+
+/**
+ * Weak scaling row of a function and variant, each thread count on a problem grown in proportion to it
+ * Growing the dimension leaves the specialized instance behind, so then every size runs the runtime optimizer
+ */
+vector<Benchmark> executeWeakScaling(const FunctionBenchmark &func, const Variant &variant)
+{
+    const PopulationScope scope;
+    const vector<WeakSize> sizes = weakSizes(func);
+    Variant grown = variant;
+    vector<Benchmark> row;
+
+    for (const WeakSize &size : sizes)
+        grown.options.specialized = grown.options.specialized && size.dim == func.dim;
+
+    for (size_t column = 0; column < threadCounts.size(); ++column)
+    {
+        FunctionBenchmark sized = func;
+        sized.dim = sizes[column].dim;
+        populationSize = sizes[column].population;
+
+        row.push_back(executeBenchmark(sized, grown, threadCounts[column], -1));
+    }
+
+    return row;
+}
+
+/**
+ * Row of the population comparison, a function and variant at every size of neighbourPopulations
+ */
+vector<Benchmark> executePopulationSweep(const FunctionBenchmark &func, const Variant &variant)
+{
+    const PopulationScope scope;
+    vector<Benchmark> row;
+
+    for (int population : neighbourPopulations)
+    {
+        populationSize = population;
+        row.push_back(executeBenchmark(func, variant, threadCounts.back(), -1));
+    }
+
+    return row;
+}
+
+/**
+ * Scaling study of one row, from its strong scaling times and the weak scaling times of the same row
+ */
+ScalingStudy rowScaling(const vector<Benchmark> &strong, const vector<Benchmark> &weak)
+{
+    vector<double> strongSeconds;
+    vector<double> weakSeconds;
+
+    for (size_t j = 0; j < strong.size(); j++)
+    {
+        strongSeconds.push_back(strong[j].time.count());
+        weakSeconds.push_back(weak[j].time.count());
+    }
+
+    const vector<WeakSize> sizes = weakSizes(findByName(selectedFunctions, strong[0].functionName, "function"));
+
+    return studyScaling(threadCounts, strongSeconds, weakSeconds, sizes, efficiencyThreshold);
+}
+
+/**
+ * Label of a table row, the function name followed by the variant
+ */
+string rowLabel(const Benchmark &bench)
+{
+    return bench.functionName + " " + bench.variantName;
+}
+
+/**
+ * Print the table header
+ */
+void printTableHeader()
+{
+    printElement("Function", nameWidth);
+
+    for (int threads : threadCounts)
+        printElement(threadLabel(threads), numWidth);
+}
+
+/**
+ * Print the table title
+ */
+void printTableTitle(string title, int titlePadding = 2, int extraCells = 0)
+{
+    printTitle(title, extraCells + (int)threadCounts.size(), titlePadding);
+}
+
+/**
+ * Print the results table
+ */
+void printResultsTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Average Results Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (int i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElement(allBenchmarkData[i][j].averageResult, numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the best results table
+ */
+void printBestResultsTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Best Results Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (int i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElement(allBenchmarkData[i][j].bestResult, numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the speedup table
+ */
+void printSpeedupTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Speedup Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (int i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            double speedup = allBenchmarkData[i][0].time / allBenchmarkData[i][j].time;
+
+            // Print in the format "1.5x"
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(1) << speedup << "x";
+            std::string speedupStr = stream.str();
+            std::cout << std::left << std::setw(numWidth) << speedupStr;
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the speedup of every variant over the first variant of the same function
+ */
+void printVariantSpeedupTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Variant Speedup Table (vs " + selectedVariants[0].name + ")");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const vector<Benchmark> &reference = allBenchmarkData[i - i % selectedVariants.size()];
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            double speedup = reference[j].time / allBenchmarkData[i][j].time;
+
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2) << speedup << "x";
+            std::cout << std::left << std::setw(numWidth) << stream.str();
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the time per run spent generating bulk noise, summed over threads
+ */
+void printRngTimeTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("RNG Time Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElementPrecise(allBenchmarkData[i][j].rngTime, numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the average time a thread waits for the rest of the team at the end of every generation
+ */
+void printSyncTimeTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Sync Time per Generation Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElementPrecise(chrono::duration<double, micro>(allBenchmarkData[i][j].syncTime), numWidth, 2);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the median, over runs, of the per-run time samples
+ */
+void printMedianTimeTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Median Run Time Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElementPrecise(chrono::duration<double>(allBenchmarkData[i][j].timing.median), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the process CPU time per run, summed over all threads
+ */
+void printCpuTimeTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("CPU Time Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElementPrecise(allBenchmarkData[i][j].cpuTime, numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Bootstrap confidence interval of the speedup of a benchmark over the first thread count of its row
+ */
+ConfidenceInterval speedupInterval(const vector<Benchmark> &row, int column)
+{
+    return bootstrapSpeedup(row[0].samples, row[column].samples, 2000, 0.95, randomSeed + column);
+}
+
+/**
+ * Print the 95% bootstrap confidence interval of the speedup
+ */
+void printSpeedupIntervalTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Speedup 95% CI Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            ConfidenceInterval interval = speedupInterval(allBenchmarkData[i], j);
+
+            // Print in the format "1.4-1.6x"
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(1) << interval.low << "-" << interval.high << "x";
+            printElement(stream.str(), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the objective evaluations per run
+ */
+void printEvaluationsTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Evaluations per Run Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElement(allBenchmarkData[i][j].evaluations, numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Row a deferred-evaluation variant is compared against, the first per-move variant of the same function and layout,
+ * -1 for per-move rows and when no such variant was selected
+ */
+int perMoveRow(vector<vector<Benchmark>> &allBenchmarkData, int i)
+{
+    const FireflyOptions &options = findByName(selectedVariants, allBenchmarkData[i][0].variantName, "variant").options;
+
+    if (!deferredEvaluation(options))
+        return -1;
+
+    for (size_t r = 0; r < allBenchmarkData.size(); r++)
+    {
+        const Benchmark &bench = allBenchmarkData[r][0];
+        const FireflyOptions &reference = findByName(selectedVariants, bench.variantName, "variant").options;
+
+        if (bench.functionName == allBenchmarkData[i][0].functionName && !deferredEvaluation(reference) &&
+            reference.layout == options.layout)
+            return r;
+    }
+
+    return -1;
+}
+
+/**
+ * Whether any selected variant defers evaluation
+ */
+bool deferredEvaluationSelected()
+{
+    return any_of(selectedVariants.begin(), selectedVariants.end(), [](const Variant &variant)
+                  { return deferredEvaluation(variant.options); });
+}
+
+/**
+ * Print the evaluations the deferred-evaluation rows saved against per-move evaluation next to what it cost them in
+ * average result, positive when it got worse
+ */
+void printDeferredTables(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Deferred Evaluations Table (vs per move)");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const int reference = perMoveRow(allBenchmarkData, i);
+
+        if (reference < 0)
+            continue;
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2) << allBenchmarkData[i][j].evaluations / max(allBenchmarkData[reference][j].evaluations, 1.0) << "x";
+            printElement(stream.str(), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+
+    printTableTitle("Deferred Quality Table (average result - per move)");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const int reference = perMoveRow(allBenchmarkData, i);
+
+        if (reference < 0)
+            continue;
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+            printElement(allBenchmarkData[i][j].averageResult - allBenchmarkData[reference][j].averageResult, numWidth);
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print how many runs reached the target, and their average time and evaluations to reach it
+ */
+void printTargetTables(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Target Hits Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            printElement(to_string(allBenchmarkData[i][j].targetHits) + "/" + to_string(numberOfRuns), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+
+    printTableTitle("Time to Target Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            if (allBenchmarkData[i][j].targetHits > 0)
+                printElementPrecise(allBenchmarkData[i][j].timeToTarget, numWidth);
+            else
+                printElement("-", numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+
+    printTableTitle("Evaluations to Target Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            if (allBenchmarkData[i][j].targetHits > 0)
+                printElement(allBenchmarkData[i][j].evaluationsToTarget, numWidth);
+            else
+                printElement("-", numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print one value per thread count of every row of the scaling study, "-" where a value is undefined
+ */
+void printScalingTable(string title, vector<vector<Benchmark>> &allBenchmarkData, const vector<ScalingStudy> &studies, vector<double> ScalingStudy::*values)
+{
+    printTableTitle(title);
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (double value : studies[i].*values)
+        {
+            if (!isFiniteValue(value))
+                printElement("-", numWidth);
+            else
+                printElementPrecise(value, numWidth, 3);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the strong and weak scaling efficiency, the Karp-Flatt serial fraction and the fitted models of every row
+ * The limits are the largest thread counts that keep the efficiency at efficiencyThreshold
+ */
+void printScalingTables(vector<vector<Benchmark>> &allBenchmarkData, vector<vector<Benchmark>> &weakBenchmarkData)
+{
+    vector<ScalingStudy> studies;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+        studies.push_back(rowScaling(allBenchmarkData[i], weakBenchmarkData[i]));
+
+    printTableTitle("Weak Scaling Size Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (const WeakSize &size : weakSizes(findByName(selectedFunctions, allBenchmarkData[i][0].functionName, "function")))
+            printElement(to_string(size.population) + " x " + to_string(size.dim), numWidth);
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+
+    printScalingTable("Strong Scaling Efficiency Table", allBenchmarkData, studies, &ScalingStudy::strongEfficiency);
+    printScalingTable("Karp-Flatt Serial Fraction Table", allBenchmarkData, studies, &ScalingStudy::karpFlatt);
+    printScalingTable("Scaled Speedup Table", allBenchmarkData, studies, &ScalingStudy::weakSpeedup);
+    printScalingTable("Weak Scaling Efficiency Table", allBenchmarkData, studies, &ScalingStudy::weakEfficiency);
+
+    printTableTitle("Scaling Model Table", 2, 7 - (int)threadCounts.size());
+    printElement("Function", nameWidth);
+    printElement("Amdahl f", numWidth);
+    printElement("Amdahl max", numWidth);
+    printElement("Amdahl R2", numWidth);
+    printElement("Gustafson a", numWidth);
+    printElement("Gustafson R2", numWidth);
+    printElement("Strong limit", numWidth);
+    printElement("Weak limit", numWidth);
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const ScalingStudy &study = studies[i];
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (double value : {study.amdahl.serialFraction, 1.0 / study.amdahl.serialFraction, study.amdahl.rSquared, study.gustafson.serialFraction, study.gustafson.rSquared})
+        {
+            std::ostringstream stream;
+            stream << std::setprecision(3) << value;
+            printElement(isFiniteValue(value) ? stream.str() : "-", numWidth);
+        }
+
+        printElement(study.strongLimit > 0 ? threadLabel(study.strongLimit) : "-", numWidth);
+        printElement(study.weakLimit > 0 ? threadLabel(study.weakLimit) : "-", numWidth);
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Row of the population comparison the neighbour-limited variants of a function are compared against,
+ * its first variant that compares all pairs, -1 when none was selected
+ */
+int allPairsRow(vector<vector<Benchmark>> &populationBenchmarkData, int i)
+{
+    for (size_t r = 0; r < populationBenchmarkData.size(); r++)
+    {
+        const Benchmark &bench = populationBenchmarkData[r][0];
+
+        if (bench.functionName == populationBenchmarkData[i][0].functionName &&
+            findByName(selectedVariants, bench.variantName, "variant").options.neighbourhood == Neighbourhood::All)
+            return r;
+    }
+
+    return -1;
+}
+
+/**
+ * Print one table of the population comparison, a column per population size
+ */
+void printPopulationTable(string title, vector<vector<Benchmark>> &populationBenchmarkData, function<string(int, int)> cell)
+{
+    printTableTitle(title, 2, (int)neighbourPopulations.size() - (int)threadCounts.size());
+    printElement("Function", nameWidth);
+
+    for (int population : neighbourPopulations)
+        printElement("N = " + to_string(population), numWidth);
+
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < populationBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(populationBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < populationBenchmarkData[i].size(); j++)
+            printElement(cell(i, j), numWidth);
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print throughput and quality of every variant as the population grows, and both relative to all pairs
+ * Throughput counts firefly updates, fireflies times generations, per second
+ */
+void printPopulationTables(vector<vector<Benchmark>> &populationBenchmarkData)
+{
+    auto format = [](double value, int precision)
+    {
+        std::ostringstream stream;
+        stream << std::setprecision(precision) << value;
+        return stream.str();
+    };
+
+    printPopulationTable("Population Time Table", populationBenchmarkData, [&](int i, int j)
+                         { return format(populationBenchmarkData[i][j].time.count(), 4) + "s"; });
+
+    printPopulationTable("Population Throughput Table (updates/s)", populationBenchmarkData, [&](int i, int j)
+                         {
+                             const Benchmark &bench = populationBenchmarkData[i][j];
+                             return format(neighbourPopulations[j] * bench.generations / bench.time.count(), 3); });
+
+    printPopulationTable("Population Average Results Table", populationBenchmarkData, [&](int i, int j)
+                         { return format(populationBenchmarkData[i][j].averageResult, 6); });
+
+    printPopulationTable("Speedup vs All Pairs Table", populationBenchmarkData, [&](int i, int j)
+                         {
+                             const int reference = allPairsRow(populationBenchmarkData, i);
+                             return reference < 0 ? string("-") : format(populationBenchmarkData[reference][j].time / populationBenchmarkData[i][j].time, 3) + "x"; });
+}
+
+/**
+ * Row a single or mixed precision variant is compared against, the first double precision variant of the same
+ * function and layout that runs the same specialized or runtime-dimension path, -1 for double precision rows and when
+ * no such variant was selected
+ */
+int doublePrecisionRow(vector<vector<Benchmark>> &allBenchmarkData, int i)
+{
+    const FireflyOptions &options = findByName(selectedVariants, allBenchmarkData[i][0].variantName, "variant").options;
+
+    if (options.precision == Precision::Double)
+        return -1;
+
+    for (size_t r = 0; r < allBenchmarkData.size(); r++)
+    {
+        const Benchmark &bench = allBenchmarkData[r][0];
+        const FireflyOptions &reference = findByName(selectedVariants, bench.variantName, "variant").options;
+
+        if (bench.functionName == allBenchmarkData[i][0].functionName && reference.precision == Precision::Double &&
+            reference.layout == options.layout && specializedPath(reference) == specializedPath(options))
+            return r;
+    }
+
+    return -1;
+}
+
+/**
+ * Whether any selected variant runs in single or mixed precision
+ */
+bool reducedPrecisionSelected()
+{
+    return any_of(selectedVariants.begin(), selectedVariants.end(), [](const Variant &variant)
+                  { return variant.options.precision != Precision::Double; });
+}
+
+/**
+ * Print the speedup of the single and mixed precision rows over double precision, and how much their average result
+ * moved, positive when it got worse
+ */
+void printPrecisionTables(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Precision Speedup Table (vs double)");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const int reference = doublePrecisionRow(allBenchmarkData, i);
+
+        if (reference < 0)
+            continue;
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2) << allBenchmarkData[reference][j].time / allBenchmarkData[i][j].time << "x";
+            printElement(stream.str(), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+
+    printTableTitle("Precision Quality Table (average result - double)");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const int reference = doublePrecisionRow(allBenchmarkData, i);
+
+        if (reference < 0)
+            continue;
+
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+            printElement(allBenchmarkData[i][j].averageResult - allBenchmarkData[reference][j].averageResult, numWidth);
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the tiles stolen per generation and the average time a thread spent idle per generation
+ * Only tiled variants run the work-stealing scheduler, the other rows stay empty
+ */
+void printSchedulerTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    printTableTitle("Steals, Idle per Generation Table");
+    printTableHeader();
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        printElement(rowLabel(allBenchmarkData[i][0]), nameWidth);
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const vector<SchedulerStats> &scheduler = allBenchmarkData[i][j].scheduler;
+
+            if (scheduler.empty())
+            {
+                printElement("-", numWidth);
+                continue;
+            }
+
+            long steals = 0;
+            double idleSeconds = 0.0;
+
+            for (const SchedulerStats &thread : scheduler)
+            {
+                steals += thread.steals;
+                idleSeconds += thread.idleSeconds;
+            }
+
+            // Generations actually run, fewer than maxGenerations when a stopping criterion fired
+            const double generations = max(numberOfRuns * allBenchmarkData[i][j].generations, 1.0);
+
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(1) << steals / generations << ", "
+                   << idleSeconds / (generations * scheduler.size()) * 1e6 << "µs";
+            printElement(stream.str(), numWidth);
+        }
+
+        cout << endl;
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print where the threads spent their time, as shares of the phase time summed over threads,
+ * with that sum per run in the last column. One row per function, variant and thread count.
+ */
+void printPhaseTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    if (!phaseTimersEnabled)
+        return;
+
+    printTableTitle("Phase Breakdown Table", 2, 2 + phaseCount - (int)threadCounts.size());
+    printElement("Function", nameWidth);
+    printElement("Threads", numWidth);
+
+    for (const string &name : phaseNames)
+        printElement(name, numWidth);
+
+    printElement("Total", numWidth);
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+            PhaseTimes total{};
+            double sum = 0.0;
+
+            for (const PhaseTimes &thread : bench.phases)
+            {
+                for (int phase = 0; phase < phaseCount; ++phase)
+                {
+                    total[phase] += thread[phase];
+                    sum += thread[phase];
+                }
+            }
+
+            printElement(rowLabel(bench), nameWidth);
+            printElement(threadLabel(bench.threadCount), numWidth);
+
+            for (int phase = 0; phase < phaseCount; ++phase)
+            {
+                std::ostringstream stream;
+                stream << std::fixed << std::setprecision(1) << (sum > 0.0 ? total[phase] / sum * 100.0 : 0.0) << "%";
+                printElement(stream.str(), numWidth);
+            }
+
+            printElementPrecise(chrono::duration<double>(sum), numWidth);
+            cout << endl;
+        }
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Print the hardware events per run, only when the counters could be opened
+ */
+void printCounterTable(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    if (allBenchmarkData.empty() || !allBenchmarkData[0][0].counters.valid)
+        return;
+
+    printTableTitle("Hardware Counter Table", 2, 6 - (int)threadCounts.size());
+    printElement("Function", nameWidth);
+    printElement("Threads", numWidth);
+    printElement("Cycles", numWidth);
+    printElement("Instructions", numWidth);
+    printElement("IPC", numWidth);
+    printElement("Cache misses", numWidth);
+    printElement("Branch misses", numWidth);
+    cout << endl;
+    cout << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+            const HardwareCounters &counters = bench.counters;
+
+            printElement(rowLabel(bench), nameWidth);
+            printElement(threadLabel(bench.threadCount), numWidth);
+
+            for (double value : {counters.cycles, counters.instructions, counters.instructions / counters.cycles, counters.cacheMisses, counters.branchMisses})
+            {
+                std::ostringstream stream;
+                stream << std::setprecision(3) << value;
+                printElement(stream.str(), numWidth);
+            }
+
+            cout << endl;
+        }
+    }
+
+    cout << endl;
+    cout << endl;
+}
+
+/**
+ * Write the phase times of every firefly-level thread per run, and the hardware events per run, to phases.csv
+ */
+void writePhaseCSV(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    ofstream phaseFile("phases.csv");
+
+    phaseFile << "Function,Variant,Threads,Thread";
+
+    for (const string &name : phaseNames)
+        phaseFile << "," << name << " seconds";
+
+    phaseFile << ",Cycles,Instructions,Cache misses,Branch misses" << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+
+            // The counters cover the whole process, they are written once on the row of thread 0,
+            // which is the only row when the phase timers are compiled out
+            for (size_t thread = 0; thread < max<size_t>(bench.phases.size(), 1); ++thread)
+            {
+                phaseFile << bench.functionName << "," << bench.variantName << "," << bench.threadCount << "," << thread;
+
+                for (int phase = 0; phase < phaseCount; ++phase)
+                {
+                    phaseFile << ",";
+
+                    if (thread < bench.phases.size())
+                        phaseFile << bench.phases[thread][phase];
+                }
+
+                if (thread == 0 && bench.counters.valid)
+                    phaseFile << "," << bench.counters.cycles << "," << bench.counters.instructions << ","
+                              << bench.counters.cacheMisses << "," << bench.counters.branchMisses;
+                else
+                    phaseFile << ",,,,";
+
+                phaseFile << endl;
+            }
+        }
+    }
+
+    phaseFile.close();
+}
+
+/**
+ * Write the per-thread scheduler statistics of the tiled variants, averaged per run
+ */
+void writeSchedulerCSV(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    ofstream schedulerFile("scheduler.csv");
+
+    schedulerFile << "Function,Threads,Thread,Tiles,Steals,Idle seconds" << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+
+            for (size_t thread = 0; thread < bench.scheduler.size(); ++thread)
+            {
+                schedulerFile << rowLabel(bench) << "," << bench.threadCount << "," << thread << ","
+                              << (double)bench.scheduler[thread].tiles / numberOfRuns << ","
+                              << (double)bench.scheduler[thread].steals / numberOfRuns << ","
+                              << bench.scheduler[thread].idleSeconds / numberOfRuns << endl;
+            }
+        }
+    }
+
+    schedulerFile.close();
+}
+
+/**
+ * JSON array of numbers
+ */
+template <typename T>
+string jsonArray(const vector<T> &values)
+{
+    string text = "[";
+
+    for (size_t i = 0; i < values.size(); ++i)
+        text += (i > 0 ? ", " : "") + jsonNumber(values[i]);
+
+    return text + "]";
+}
+
+/**
+ * Write every benchmark with its timing statistics, speedup interval and samples to benchmark.json
+ */
+void writeJSONFile(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    ofstream file("benchmark.json");
+
+    file << "{" << endl;
+    file << "  \"seed\": " << randomSeed << "," << endl;
+    file << "  \"runs\": " << numberOfRuns << "," << endl;
+    file << "  \"warmupRuns\": " << warmupRuns << "," << endl;
+    file << "  \"population\": " << populationSize << "," << endl;
+    file << "  \"generations\": " << maxGenerations << "," << endl;
+    file << "  \"threads\": " << jsonArray(threadCounts) << "," << endl;
+    file << "  \"math\": " << jsonString(mathModeNames[int(mathMode)]) << "," << endl;
+    file << "  \"islands\": {\"count\": " << islandCount << ", \"migrationInterval\": " << migrationInterval << ", \"migrationSize\": " << migrationSize << "}," << endl;
+    file << "  \"benchmarks\": [";
+
+    bool first = true;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+            ConfidenceInterval interval = speedupInterval(allBenchmarkData[i], j);
+
+            file << (first ? "" : ",") << endl;
+            file << "    {" << endl;
+            file << "      \"function\": " << jsonString(bench.functionName) << "," << endl;
+            file << "      \"variant\": " << jsonString(bench.variantName) << "," << endl;
+            file << "      \"threads\": " << bench.threadCount << "," << endl;
+            file << "      \"time\": " << jsonNumber(bench.time.count()) << "," << endl;
+            file << "      \"cpuTime\": " << jsonNumber(bench.cpuTime.count()) << "," << endl;
+            file << "      \"median\": " << jsonNumber(bench.timing.median) << "," << endl;
+            file << "      \"min\": " << jsonNumber(bench.timing.min) << "," << endl;
+            file << "      \"mean\": " << jsonNumber(bench.timing.mean) << "," << endl;
+            file << "      \"stddev\": " << jsonNumber(bench.timing.stddev) << "," << endl;
+            file << "      \"speedup\": " << jsonNumber(allBenchmarkData[i][0].time / bench.time) << "," << endl;
+            file << "      \"speedupCI95\": " << jsonArray(vector<double>{interval.low, interval.high}) << "," << endl;
+            file << "      \"averageResult\": " << jsonNumber(bench.averageResult) << "," << endl;
+            file << "      \"bestResult\": " << jsonNumber(bench.bestResult) << "," << endl;
+            file << "      \"evaluations\": " << jsonNumber(bench.evaluations) << "," << endl;
+            file << "      \"targetHits\": " << bench.targetHits << "," << endl;
+            file << "      \"timeToTarget\": " << jsonNumber(bench.timeToTarget.count()) << "," << endl;
+            file << "      \"evaluationsToTarget\": " << jsonNumber(bench.evaluationsToTarget) << "," << endl;
+            file << "      \"migrants\": " << jsonNumber(bench.migrants) << "," << endl;
+            file << "      \"phases\": {";
+
+            for (int phase = 0; phase < phaseCount; ++phase)
+            {
+                vector<double> threads;
+
+                for (const PhaseTimes &thread : bench.phases)
+                    threads.push_back(thread[phase]);
+
+                file << (phase > 0 ? ", " : "") << jsonString(phaseNames[phase]) << ": " << jsonArray(threads);
+            }
+
+            file << "}," << endl;
+
+            if (bench.counters.valid)
+                file << "      \"counters\": {\"cycles\": " << jsonNumber(bench.counters.cycles)
+                     << ", \"instructions\": " << jsonNumber(bench.counters.instructions)
+                     << ", \"cacheMisses\": " << jsonNumber(bench.counters.cacheMisses)
+                     << ", \"branchMisses\": " << jsonNumber(bench.counters.branchMisses) << "}," << endl;
+
+            file << "      \"samples\": " << jsonArray(bench.samples) << endl;
+            file << "    }";
+
+            first = false;
+        }
+    }
+
+    file << endl;
+    file << "  ]" << endl;
+    file << "}" << endl;
+
+    file.close();
+}
+
+/**
+ * Write one line per timed run to samples.csv
+ */
+void writeSamplesCSV(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    ofstream samplesFile("samples.csv");
+
+    samplesFile << "Function,Variant,Threads,Run,Seconds,Best fitness" << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+
+            for (size_t run = 0; run < bench.samples.size(); ++run)
+            {
+                samplesFile << bench.functionName << "," << bench.variantName << "," << bench.threadCount << "," << run << ","
+                            << std::setprecision(9) << bench.samples[run] << "," << bench.results[run] << endl;
+            }
+        }
+    }
+
+    samplesFile.close();
+}
+
+/**
+ * Write the scaling study, one line per row and thread count to scaling.csv and one per row to scaling_models.csv
+ */
+void writeScalingCSV(vector<vector<Benchmark>> &allBenchmarkData, vector<vector<Benchmark>> &weakBenchmarkData)
+{
+    ofstream scalingFile("scaling.csv");
+    ofstream modelsFile("scaling_models.csv");
+
+    scalingFile << "Function,Variant,Threads,Seconds,Speedup,Efficiency,Karp-Flatt,Weak population,Weak dim,Weak seconds,Scaled speedup,Weak efficiency" << endl;
+    modelsFile << "Function,Variant,Amdahl serial fraction,Amdahl max speedup,Amdahl R2,Gustafson serial fraction,Gustafson R2,Strong limit,Weak limit" << endl;
+
+    // Empty cells where a metric is undefined, such as the serial fraction of the first thread count
+    auto value = [](double number)
+    {
+        std::ostringstream stream;
+
+        if (isFiniteValue(number))
+            stream << number;
+
+        return stream.str();
+    };
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const Benchmark &first = allBenchmarkData[i][0];
+        const ScalingStudy study = rowScaling(allBenchmarkData[i], weakBenchmarkData[i]);
+        const vector<WeakSize> sizes = weakSizes(findByName(selectedFunctions, first.functionName, "function"));
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            scalingFile << first.functionName << "," << first.variantName << "," << threadCounts[j] << ","
+                        << allBenchmarkData[i][j].time.count() << "," << study.strongSpeedup[j] << "," << study.strongEfficiency[j] << ","
+                        << value(study.karpFlatt[j]) << "," << sizes[j].population << "," << sizes[j].dim << "," << weakBenchmarkData[i][j].time.count() << ","
+                        << study.weakSpeedup[j] << "," << study.weakEfficiency[j] << endl;
+        }
+
+        modelsFile << first.functionName << "," << first.variantName << "," << value(study.amdahl.serialFraction) << ","
+                   << value(1.0 / study.amdahl.serialFraction) << "," << value(study.amdahl.rSquared) << ","
+                   << value(study.gustafson.serialFraction) << "," << value(study.gustafson.rSquared) << ","
+                   << study.strongLimit << "," << study.weakLimit << endl;
+    }
+
+    scalingFile.close();
+    modelsFile.close();
+}
+
+/**
+ * Write the population comparison to populations.csv, one line per function, variant and population size
+ */
+void writePopulationCSV(vector<vector<Benchmark>> &populationBenchmarkData)
+{
+    ofstream populationFile("populations.csv");
+
+    populationFile << "Function,Variant,Population,Threads,Seconds,Updates per second,Average result,Best result,Speedup vs all pairs,All pairs average result" << endl;
+
+    for (size_t i = 0; i < populationBenchmarkData.size(); i++)
+    {
+        const int reference = allPairsRow(populationBenchmarkData, i);
+
+        for (size_t j = 0; j < populationBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = populationBenchmarkData[i][j];
+
+            populationFile << bench.functionName << "," << bench.variantName << "," << neighbourPopulations[j] << "," << bench.threadCount << ","
+                           << bench.time.count() << "," << neighbourPopulations[j] * bench.generations / bench.time.count() << ","
+                           << bench.averageResult << "," << bench.bestResult << ",";
+
+            // Empty cells when no variant comparing all pairs was selected
+            if (reference >= 0)
+                populationFile << populationBenchmarkData[reference][j].time / bench.time << "," << populationBenchmarkData[reference][j].averageResult;
+            else
+                populationFile << ",";
+
+            populationFile << endl;
+        }
+    }
+
+    populationFile.close();
+}
+
+/**
+ * Write the precision comparison to precision.csv, one line per single or mixed precision row and thread count
+ */
+void writePrecisionCSV(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    ofstream precisionFile("precision.csv");
+
+    precisionFile << "Function,Variant,Threads,Reference variant,Seconds,Reference seconds,Speedup,Average result,Reference average result,Difference" << endl;
+
+    for (size_t i = 0; i < allBenchmarkData.size(); i++)
+    {
+        const int reference = doublePrecisionRow(allBenchmarkData, i);
+
+        if (reference < 0)
+            continue;
+
+        for (size_t j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            const Benchmark &bench = allBenchmarkData[i][j];
+            const Benchmark &base = allBenchmarkData[reference][j];
+
+            precisionFile << bench.functionName << "," << bench.variantName << "," << bench.threadCount << "," << base.variantName << ","
+                          << bench.time.count() << "," << base.time.count() << "," << base.time / bench.time << ","
+                          << bench.averageResult << "," << base.averageResult << "," << bench.averageResult - base.averageResult << endl;
+        }
+    }
+
+    precisionFile.close();
+}
+
+/**
+ * Write the benchmark data to CSV files
+ */
+void writeCSVFiles(vector<vector<Benchmark>> &allBenchmarkData)
+{
+    string timeCSV = "time.csv";
+    string resultCSV = "result.csv";
+    string speedupCSV = "speedup.csv";
+    string timeToTargetCSV = "time_to_target.csv";
+    string evaluationsToTargetCSV = "evals_to_target.csv";
+
+    ofstream timeFile(timeCSV);
+    ofstream resultFile(resultCSV);
+    ofstream speedupFile(speedupCSV);
+    ofstream timeToTargetFile(timeToTargetCSV);
+    ofstream evaluationsToTargetFile(evaluationsToTargetCSV);
+
+    timeFile << "Function,";
+    resultFile << "Function,";
+    speedupFile << "Function,";
+    timeToTargetFile << "Function,";
+    evaluationsToTargetFile << "Function,";
+
+    for (int threads : threadCounts)
+    {
+        timeFile << threadLabel(threads) + ",";
+        resultFile << threadLabel(threads) + ",";
+        speedupFile << threadLabel(threads) + ",";
+        timeToTargetFile << threadLabel(threads) + ",";
+        evaluationsToTargetFile << threadLabel(threads) + ",";
+    }
+
+    timeFile << endl;
+    resultFile << endl;
+    speedupFile << endl;
+    timeToTargetFile << endl;
+    evaluationsToTargetFile << endl;
+
+    for (int i = 0; i < allBenchmarkData.size(); i++)
+    {
+        timeFile << rowLabel(allBenchmarkData[i][0]) + ",";
+        resultFile << rowLabel(allBenchmarkData[i][0]) + ",";
+        speedupFile << rowLabel(allBenchmarkData[i][0]) + ",";
+        timeToTargetFile << rowLabel(allBenchmarkData[i][0]) + ",";
+        evaluationsToTargetFile << rowLabel(allBenchmarkData[i][0]) + ",";
+
+        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        {
+            timeFile << allBenchmarkData[i][j].time.count() << ",";
+            resultFile << allBenchmarkData[i][j].averageResult << ",";
+
+            double speedup = allBenchmarkData[i][0].time / allBenchmarkData[i][j].time;
+            speedupFile << speedup << ",";
+
+            // Empty cell when no run reached the target
+            if (allBenchmarkData[i][j].targetHits > 0)
+            {
+                timeToTargetFile << allBenchmarkData[i][j].timeToTarget.count();
+                evaluationsToTargetFile << allBenchmarkData[i][j].evaluationsToTarget;
+            }
+
+            timeToTargetFile << ",";
+            evaluationsToTargetFile << ",";
+        }
+
+        timeFile << endl;
+        resultFile << endl;
+        speedupFile << endl;
+        timeToTargetFile << endl;
+        evaluationsToTargetFile << endl;
+    }
+
+    timeFile.close();
+    resultFile.close();
+    speedupFile.close();
+    timeToTargetFile.close();
+    evaluationsToTargetFile.close();
+}
+
+/**
+ * Print the CPUs the process may use and where the threads of the largest thread count are placed
+ */
+void printTopology(const Topology &topology)
+{
+    auto plural = [](int count, const string &name)
+    {
+        return to_string(count) + " " + name + (count == 1 ? "" : "s");
+    };
+
+    vector<int> available;
+
+    for (const CpuInfo &info : topology.cpus)
+        available.push_back(info.cpu);
+
+    cout << "Topology: " << plural(topology.packages, "package") << ", " << plural(topology.nodes, "NUMA node") << ", "
+         << plural(topology.cores, "core") << ", " << plural(topology.cpus.size(), "CPU") << " (" << formatCpuList(available) << ")" << endl;
+
+    cout << "Math: " << mathModeNames[int(mathMode)] << ", SIMD width " << SimdDouble::width << endl;
+
+    const int maxThreads = *max_element(threadCounts.begin(), threadCounts.end());
+
+    if (threadPlacement.empty())
+    {
+        cout << "Pinning: none, the operating system places the threads" << endl;
+        cout << endl;
+        return;
+    }
+
+    const string policyNames[] = {"none", "compact", "scatter", "list"};
+    cout << "Pinning: " << policyNames[int(pinPolicy)] << ", " << maxThreads << " threads" << endl;
+
+    // Threads and CPUs per NUMA node, in node order
+    map<int, pair<vector<int>, vector<int>>> nodes;
+
+    for (int thread = 0; thread < maxThreads; ++thread)
+    {
+        const int cpu = threadPlacement[thread % threadPlacement.size()];
+        const auto info = find_if(topology.cpus.begin(), topology.cpus.end(), [&](const CpuInfo &info)
+                                  { return info.cpu == cpu; });
+
+        nodes[info->node].first.push_back(thread);
+        nodes[info->node].second.push_back(cpu);
+    }
+
+    for (const auto &[node, placed] : nodes)
+        cout << "  node " << node << ": threads " << formatCpuList(placed.first) << " on CPUs " << formatCpuList(placed.second) << endl;
+
+    if (size_t(maxThreads) > threadPlacement.size())
+        cout << "  more threads than CPUs, threads " << threadPlacement.size() << " and up share CPUs" << endl;
+
+    cout << endl;
+}
+
+/**
+ * Print the settings the config file and command line accept
+ */
+void printUsage()
+{
+    cout << "Usage: firefly [--key value | --key=value]... [--config file]" << endl;
+    cout << endl;
+    cout << "A config file holds the same settings as key = value lines, # starts a comment." << endl;
+    cout << "Settings apply in order, so arguments after --config override the file." << endl;
+    cout << endl;
+    cout << "  functions = a,b,...       functions to benchmark (default all)" << endl;
+    cout << "  variants = a,b,...|all    optimizer variants to benchmark (default the ones listed as default below)" << endl;
+    cout << "  dim = N                   dimension of every function not fixed to one" << endl;
+    cout << "  dim.<function> = N        dimension of one function" << endl;
+    cout << "  range.<function> = lo,hi  search range of one function" << endl;
+    cout << "  threads = a,b,...         thread counts, one table column each" << endl;
+    cout << "  runs = N                  runs per benchmark (default " << numberOfRuns << ")" << endl;
+    cout << "  warmup = N                untimed runs before every benchmark (default " << warmupRuns << ")" << endl;
+    cout << "  population = N            fireflies (default " << populationSize << ")" << endl;
+    cout << "  generations = N           generations per run (default " << maxGenerations << ")" << endl;
+    cout << "  alpha = start[,end]       randomness, growing from start to end (default " << randomnessStart << "," << randomnessEnd << ")" << endl;
+    cout << "  beta = B                  attractiveness at distance 0 (default " << attractivenessConstant << ")" << endl;
+    cout << "  gamma = G                 light absorption coefficient (default " << absorptionCoefficient << ")" << endl;
+    cout << "  seed = N                  master seed of every random stream" << endl;
+    cout << "  pin = none|compact|scatter|cpu list  thread placement, a list such as 0,2,4-7 (default none)" << endl;
+    cout << "  counters = on|off         count hardware events with perf_event_open (default off)" << endl;
+    cout << "  math = libm|precise|fast  how the objectives evaluate sin, cos, exp and sqrt (default libm)" << endl;
+    cout << "  islands = N               swarms of an island variant, sharing its thread count (default " << islandCount << ")" << endl;
+    cout << "  migration.interval = N    generations between migrations (default " << migrationInterval << ")" << endl;
+    cout << "  migration.size = N        best fireflies every island sends per migration (default " << migrationSize << ")" << endl;
+    cout << "  checkpoint = file|off     where the sweep saves its progress, such as checkpoint.bin (default off)" << endl;
+    cout << "  checkpoint.interval = S   seconds between snapshots of a run in flight (default " << checkpoint.interval << ")" << endl;
+    cout << "  resume                    continue the sweep saved in the checkpoint, with its seed" << endl;
+    cout << "  neighbours = K            fireflies every firefly of the brightest, nearest and sampled variants is compared with (default " << neighbourCount << ")" << endl;
+    cout << "  neighbours.populations = a,b,...  also run every function and variant with these populations at the largest thread count" << endl;
+    cout << "  service = stdin|path      run the jobs read from stdin or a Unix socket at path instead of the sweep" << endl;
+    cout << "  service.threads = N       threads of the pool the jobs share (default " << serviceThreads << ")" << endl;
+    cout << "  service.variant = name    variant of a job that names none (default " << serviceVariant << ")" << endl;
+    cout << "  tune = on|off             probe thread counts, schedules and chunk sizes and store the fastest instead of the sweep (default off)" << endl;
+    cout << "  tune.profile = file|off   where tune = on stores tuned settings, such as tuning.profile, and other runs load them (default off)" << endl;
+    cout << "                            a loaded profile overrides the loop schedule and chunk size of every benchmark it has settings for," << endl;
+    cout << "                            and the threads of jobs without threads=" << endl;
+    cout << "  tune.generations = N      generations of a probe run (default " << tuneGenerations << ")" << endl;
+    cout << "  tune.runs = N             timed runs of every probe (default " << tuneRuns << ")" << endl;
+    cout << "  tune.schedules = a,b,...  loop schedules to probe, static, dynamic or guided (default all)" << endl;
+    cout << "  tune.chunks = a,b,...     chunk sizes to probe with every schedule (default 1,4,16)" << endl;
+    cout << "  scaling = on|off          also run weak scaling and fit Amdahl and Gustafson models (default off)" << endl;
+    cout << "  scaling.grow = population|dimension|both  what weak scaling grows with the threads (default population)" << endl;
+    cout << "  scaling.efficiency = E    efficiency a thread count has to keep to count as scaling (default " << efficiencyThreshold << ")" << endl;
+    cout << endl;
+    cout << "Functions:";
+
+    for (const FunctionBenchmark &func : functionBenchmarks)
+        cout << " " << func.name;
+
+    cout << endl;
+    cout << "Variants:";
+
+    for (const Variant &variant : variants)
+        cout << " '" << variant.name << "'";
+
+    cout << endl;
+    cout << "Default variants:";
+
+    for (const string &name : defaultVariantNames)
+        cout << " '" << name << "'";
+
+    cout << endl;
+}
+
+/**
+ * Apply the config file and command line settings, returns false when only the usage was asked for
+ */
+bool configure(int argc, char *argv[])
+{
+    vector<string> functionNames;
+    vector<string> variantNames;
+    optional<int> dimension;
+    map<string, int> dimensions;
+    map<string, pair<double, double>> ranges;
+
+    for (const Setting &setting : parseArguments(argc, argv))
+    {
+        const string &key = setting.key;
+
+        if (key == "help")
+        {
+            printUsage();
+            return false;
+        }
+        else if (key == "functions")
+        {
+            functionNames = splitList(setting.value);
+        }
+        else if (key == "variants")
+        {
+            variantNames = splitList(setting.value);
+        }
+        else if (key == "dim")
+        {
+            dimension = parseNumber<int>(setting);
+        }
+        else if (key.rfind("dim.", 0) == 0)
+        {
+            dimensions[key.substr(4)] = parseNumber<int>(setting);
+        }
+        else if (key.rfind("range.", 0) == 0)
+        {
+            vector<double> bounds = parseNumberList<double>(setting);
+
+            if (bounds.size() != 2 || bounds[0] >= bounds[1])
+                throw runtime_error(key + " needs lo,hi with lo < hi");
+
+            ranges[key.substr(6)] = {bounds[0], bounds[1]};
+        }
+        else if (key == "threads")
+        {
+            threadCounts = parseNumberList<int>(setting);
+        }
+        else if (key == "runs")
+        {
+            numberOfRuns = parseNumber<int>(setting);
+        }
+        else if (key == "warmup")
+        {
+            warmupRuns = parseNumber<int>(setting);
+        }
+        else if (key == "population")
+        {
+            populationSize = parseNumber<int>(setting);
+        }
+        else if (key == "generations")
+        {
+            maxGenerations = parseNumber<int>(setting);
+        }
+        else if (key == "alpha")
+        {
+            vector<double> alpha = parseNumberList<double>(setting);
+
+            if (alpha.empty() || alpha.size() > 2)
+                throw runtime_error("alpha needs start or start,end");
+
+            randomnessStart = alpha[0];
+            randomnessEnd = alpha.size() > 1 ? alpha[1] : alpha[0];
+        }
+        else if (key == "beta")
+        {
+            attractivenessConstant = parseNumber<double>(setting);
+        }
+        else if (key == "gamma")
+        {
+            absorptionCoefficient = parseNumber<double>(setting);
+        }
+        else if (key == "seed")
+        {
+            randomSeed = parseNumber<uint64_t>(setting);
+        }
+        else if (key == "pin")
+        {
+            if (setting.value == "none")
+                pinPolicy = PinPolicy::None;
+            else if (setting.value == "compact")
+                pinPolicy = PinPolicy::Compact;
+            else if (setting.value == "scatter")
+                pinPolicy = PinPolicy::Scatter;
+            else
+            {
+                pinPolicy = PinPolicy::List;
+                pinList = parseCpuList(setting);
+            }
+        }
+        else if (key == "counters")
+        {
+            countHardwareEvents = parseSwitch(setting);
+        }
+        else if (key == "math")
+        {
+            mathMode = parseMathMode(setting.value);
+        }
+        else if (key == "islands")
+        {
+            islandCount = parseNumber<int>(setting);
+        }
+        else if (key == "migration.interval")
+        {
+            migrationInterval = parseNumber<int>(setting);
+        }
+        else if (key == "migration.size")
+        {
+            migrationSize = parseNumber<int>(setting);
+        }
+        else if (key == "island.worker")
+        {
+            islandWorker = setting.value;
+        }
+        else if (key == "checkpoint")
+        {
+            checkpointPath = setting.value == "off" ? "" : setting.value;
+        }
+        else if (key == "checkpoint.interval")
+        {
+            checkpoint.interval = parseNumber<double>(setting);
+        }
+        else if (key == "resume")
+        {
+            resumeSweep = setting.value.empty() || parseSwitch(setting);
+        }
+        else if (key == "neighbours")
+        {
+            neighbourCount = parseNumber<int>(setting);
+        }
+        else if (key == "neighbours.populations")
+        {
+            neighbourPopulations = parseNumberList<int>(setting);
+        }
+        else if (key == "service")
+        {
+            serviceInput = setting.value == "off" ? "" : setting.value;
+        }
+        else if (key == "service.threads")
+        {
+            serviceThreads = parseNumber<int>(setting);
+        }
+        else if (key == "service.variant")
+        {
+            serviceVariant = setting.value;
+        }
+        else if (key == "tune")
+        {
+            tuneMode = parseSwitch(setting);
+        }
+        else if (key == "tune.profile")
+        {
+            tuningPath = setting.value == "off" ? "" : setting.value;
+        }
+        else if (key == "tune.generations")
+        {
+            tuneGenerations = parseNumber<int>(setting);
+        }
+        else if (key == "tune.runs")
+        {
+            tuneRuns = parseNumber<int>(setting);
+        }
+        else if (key == "tune.schedules")
+        {
+            tuneSchedules.clear();
 
-        for (int j = 0; j < dim; ++j)
+            for (const string &name : splitList(setting.value))
+                tuneSchedules.push_back(parseSchedule(name));
+        }
+        else if (key == "tune.chunks")
+        {
+            tuneChunks = parseNumberList<int>(setting);
+        }
+        else if (key == "scaling")
         {
-            // Set position in the search space for each firefly (a vector of random values in a specific range)
-            population[i][j] = randomDouble(min_range, max_range, rng, dist);
+            scalingStudy = parseSwitch(setting);
+        }
+        else if (key == "scaling.grow")
+        {
+            weakGrowth = parseWeakGrowth(setting.value);
+        }
+        else if (key == "scaling.efficiency")
+        {
+            efficiencyThreshold = parseNumber<double>(setting);
+        }
+        else
+        {
+            throw runtime_error("unknown setting " + key);
         }
-        // Calculate the fitness values for each firefly with its initial position
-        fitness[i] = benchmark(population[i]);
     }
 
-    double randomness = randomnessStart;
+    const Topology topology = readTopology();
 
-    for (int gen = 0; gen < maxGenerations; ++gen)
+    for (int cpu : pinList)
     {
-        // Update the randomness value
-        randomness += randomnessDelta;
+        if (find_if(topology.cpus.begin(), topology.cpus.end(), [&](const CpuInfo &info) { return info.cpu == cpu; }) == topology.cpus.end())
+            throw runtime_error("CPU " + to_string(cpu) + " of pin is not available to this process");
+    }
 
-#pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < populationSize; ++i)
-        {
-            mt19937 rng(random_device{}() + omp_get_thread_num());
-            uniform_real_distribution<> dist(0.0, 1.0);
+    threadPlacement = placeThreads(topology, pinPolicy, pinList);
 
-            for (int j = 0; j < populationSize; ++j)
-            {
-                if (fitness[i] > fitness[j])
-                {
-                    int intersect = 0;
-                    int unionSize = dim;
+    if (numberOfRuns < 1)
+        throw runtime_error("runs must be at least 1");
 
-                    for (int k = 0; k < dim; ++k)
-                    {
-                        if (population[i][k] == population[j][k])
-                            intersect++;
-                        else
-                            unionSize++;
-                    }
+    if (warmupRuns < 0)
+        throw runtime_error("warmup must not be negative");
 
-                    // Calculate the distance between two vectors using cosine similarity
-                    double r = 1.0 - (double)intersect / unionSize;
+    if (populationSize < 2)
+        throw runtime_error("population must be at least 2");
 
-                    // This line calculates the attractiveness of firefly j to firefly i based on their distance r
-                    double attractiveness = attractivenessConstant * exp(-absorptionCoefficient * r * r);
+    if (maxGenerations < 1)
+        throw runtime_error("generations must be at least 1");
 
-                    for (int k = 0; k < dim; ++k)
-                    {
-                        // Multiplying attractivness with the direction from firefly i to firefly j
-                        // population[j][k] - population[i][k] (distance between the two, if negative firefly i is to the right else j is)
-                        // Then we add the randomness to prevent local optima
-                        population[i][k] += attractiveness * (population[j][k] - population[i][k]) + randomness * (randomDouble(0, 1, rng, dist) - 0.5);
-                        // Ensures that the new position of firefly i in dimension k remains within the specified bounds
-                        population[i][k] = min(max(population[i][k], min_range), max_range);
-                    }
+    if (dimension && *dimension < 1)
+        throw runtime_error("dim must be at least 1");
 
-                    // Reevalute fitness for firefly i
-                    fitness[i] = benchmark(population[i]);
-                }
-            }
-        }
-    }
+    if (islandCount < 1 || migrationInterval < 1 || migrationSize < 1)
+        throw runtime_error("islands, migration.interval and migration.size must be at least 1");
 
-    // Identifying the index of the superior firefly
-    auto min_element_it = min_element(fitness.begin(), fitness.end());
-    int best_index = distance(fitness.begin(), min_element_it);
+    if (checkpoint.interval < 0.0)
+        throw runtime_error("checkpoint.interval must not be negative");
 
-    return fitness[best_index];
-}
+    if (resumeSweep && checkpointPath.empty())
+        throw runtime_error("resume needs the checkpoint file of the sweep, given as checkpoint = file");
 
-/**
- * Execute the benchmark for a specific function and number of threads
- */
-Benchmark executeBenchmark(const FunctionBenchmark &func, int threads)
-{
-    vector<double> results(numberOfRuns);
+    if (neighbourCount < 1)
+        throw runtime_error("neighbours must be at least 1");
 
-    auto start = chrono::high_resolution_clock::now();
+    for (int population : neighbourPopulations)
+    {
+        if (population < 2)
+            throw runtime_error("neighbours.populations must be at least 2");
+    }
 
-    // Run the Firefly Algorithm multiple times
-    for (int run = 0; run < numberOfRuns; ++run)
-        results[run] = fireflyAlgorithm(func.dim, func.min_range, func.max_range, func.benchmark, threads);
+    if (serviceThreads < 1)
+        throw runtime_error("service.threads must be at least 1");
 
-    auto end = chrono::high_resolution_clock::now();
+    if (findByName(variants, serviceVariant, "variant").options.transport == IslandTransport::Processes)
+        throw runtime_error("service.variant cannot be an island process variant, they are not available to jobs");
 
-    chrono::duration<double> elapsed = end - start;
+    if (efficiencyThreshold <= 0.0 || efficiencyThreshold > 1.0)
+        throw runtime_error("scaling.efficiency must be in (0, 1]");
 
-    Benchmark bench{
-        .threadCount = threads,
-        .functionName = func.name,
-        .time = elapsed / numberOfRuns,
-        .averageResult = calculateAverage(results),
-        .bestResult = *min_element(results.begin(), results.end()),
-    };
+    if (tuneMode && (tuningPath.empty() || !serviceInput.empty()))
+        throw runtime_error("tune needs a tune.profile file to store the settings in and cannot run with the service");
 
-    return bench;
-}
+    if (tuneGenerations < 1 || tuneRuns < 1 || tuneSchedules.empty())
+        throw runtime_error("tune.generations and tune.runs must be at least 1, tune.schedules must not be empty");
 
-/**
- * Print the table header
- */
-void printTableHeader()
-{
-    printElement("Function", nameWidth);
+    for (int chunk : tuneChunks)
+    {
+        if (chunk < 1)
+            throw runtime_error("tune.chunks must be at least 1");
+    }
 
-    for (int threads = minimumThreads; threads <= numberOfThreads; threads *= 2)
-        printElement(to_string(threads) + (threads == 1 ? " Thread" : " Threads"), numWidth);
+    for (int threads : threadCounts)
+    {
+        if (threads < 1)
+            throw runtime_error("thread counts must be at least 1");
+    }
 
-    if (isNotPowerOfTwoThreads)
-        printElement(to_string(numberOfThreads) + " Threads", numWidth);
-}
+    randomnessDelta = (randomnessEnd - randomnessStart) / maxGenerations;
 
-/**
- * Print the table title
- */
-void printTableTitle(string title, int titlePadding = 2, int extraCells = 0)
-{
-    string newTitle = string(titlePadding, ' ') + title + string(titlePadding, ' ');
-    int titleWidth = newTitle.length();
+    if (!functionNames.empty())
+    {
+        selectedFunctions.clear();
 
-    int tableWidth = nameWidth + (extraCells + 1 + log2(numberOfThreads) - log2(minimumThreads)) * numWidth + (isNotPowerOfTwoThreads ? numWidth : 0);
-    int sidePadding = (tableWidth - titleWidth) / 2;
+        for (const string &name : functionNames)
+            selectedFunctions.push_back(findByName(functionBenchmarks, name, "function"));
+    }
 
-    cout << setfill('=') << setw(sidePadding) << "=";
-    cout << setfill(' ') << setw(titleWidth) << newTitle;
-    cout << setfill('=') << setw(sidePadding) << "=";
-    cout << endl;
-}
+    if (variantNames.size() == 1 && variantNames[0] == "all")
+    {
+        selectedVariants = variants;
+    }
+    else if (!variantNames.empty())
+    {
+        selectedVariants.clear();
 
-/**
- * Print the results table
- */
-void printResultsTable(vector<vector<Benchmark>> &allBenchmarkData)
-{
-    printTableTitle("Average Results Table");
-    printTableHeader();
-    cout << endl;
-    cout << endl;
+        for (const string &name : variantNames)
+            selectedVariants.push_back(findByName(variants, name, "variant"));
+    }
 
-    for (int i = 0; i < allBenchmarkData.size(); i++)
+    for (const auto &[name, dim] : dimensions)
     {
-        printElement(functionBenchmarks[i].name, nameWidth);
+        const FunctionBenchmark &func = findByName(functionBenchmarks, name, "function");
 
-        for (int j = 0; j < allBenchmarkData[i].size(); j++)
-        {
-            printElement(allBenchmarkData[i][j].averageResult, numWidth);
-        }
+        if (dim < 1)
+            throw runtime_error("dim." + name + " must be at least 1");
 
-        cout << endl;
+        if (dim != func.dim && find(fixedDimensionFunctions.begin(), fixedDimensionFunctions.end(), name) != fixedDimensionFunctions.end())
+            throw runtime_error(name + " is only defined for dimension " + to_string(func.dim));
     }
 
-    cout << endl;
-    cout << endl;
-}
+    for (const auto &[name, range] : ranges)
+        findByName(functionBenchmarks, name, "function");
 
-/**
- * Print the best results table
- */
-void printBestResultsTable(vector<vector<Benchmark>> &allBenchmarkData)
-{
-    printTableTitle("Best Results Table");
-    printTableHeader();
-    cout << endl;
-    cout << endl;
+    // A dimension without a specialized instance falls back to the runtime optimizer
+    for (FunctionBenchmark &func : selectedFunctions)
+    {
+        if (dimension && find(fixedDimensionFunctions.begin(), fixedDimensionFunctions.end(), func.name) == fixedDimensionFunctions.end())
+            func.dim = *dimension;
 
-    for (int i = 0; i < allBenchmarkData.size(); i++)
+        if (dimensions.contains(func.name))
+            func.dim = dimensions[func.name];
+
+        if (ranges.contains(func.name))
+            tie(func.min_range, func.max_range) = ranges[func.name];
+    }
+
+    // A run stops at its target only where the optimum is known, at the dimension it finally has
+    for (const FunctionBenchmark &func : selectedFunctions)
     {
-        printElement(functionBenchmarks[i].name, nameWidth);
+        vector<int> dims = {func.dim};
 
-        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        if (scalingStudy)
         {
-            printElement(allBenchmarkData[i][j].bestResult, numWidth);
+            for (const WeakSize &size : weakSizes(func))
+                dims.push_back(size.dim);
         }
 
-        cout << endl;
+        for (const Variant &variant : selectedVariants)
+        {
+            for (int dim : dims)
+            {
+                if (variant.options.stopAtTarget && !func.optimum(dim))
+                    throw runtime_error(variant.name + " stops at the target, but the optimum of " + func.name + " at dimension " + to_string(dim) + " is not known");
+            }
+        }
     }
 
-    cout << endl;
-    cout << endl;
+    return true;
 }
 
 /**
- * Print the speedup table
+ * Every setting that changes what the sweep computes, except the seed the checkpoint stores itself
  */
-void printSpeedupTable(vector<vector<Benchmark>> &allBenchmarkData)
+uint64_t sweepFingerprint()
 {
-    printTableTitle("Speedup Table");
-    printTableHeader();
-    cout << endl;
-    cout << endl;
-
-    for (int i = 0; i < allBenchmarkData.size(); i++)
-    {
-        printElement(functionBenchmarks[i].name, nameWidth);
+    ostringstream settings;
+    settings << setprecision(17);
+    settings << populationSize << ' ' << maxGenerations << ' ' << numberOfRuns << ' ' << randomnessStart << ' ' << randomnessEnd << ' '
+             << attractivenessConstant << ' ' << absorptionCoefficient << ' ' << mathModeNames[int(mathMode)] << ' '
+             << islandCount << ' ' << migrationInterval << ' ' << migrationSize << ';';
 
-        for (int j = 0; j < allBenchmarkData[i].size(); j++)
-        {
-            double speedup = allBenchmarkData[i][0].time / allBenchmarkData[i][j].time;
+    for (const FunctionBenchmark &func : selectedFunctions)
+        settings << func.name << ' ' << func.dim << ' ' << func.min_range << ' ' << func.max_range << ';';
 
-            // Print in the format "1.5x"
-            std::ostringstream stream;
-            stream << std::fixed << std::setprecision(1) << speedup << "x";
-            std::string speedupStr = stream.str();
-            std::cout << std::left << std::setw(numWidth) << speedupStr;
-        }
+    for (const Variant &variant : selectedVariants)
+        settings << variant.name << ';';
 
-        cout << endl;
-    }
+    for (int threads : threadCounts)
+        settings << threads << ';';
 
-    cout << endl;
-    cout << endl;
+    return fnv1a(settings.str());
 }
 
 /**
- * Write the benchmark data to CSV files
+ * Create the checkpoint of this sweep, or open the one to resume and take its seed
  */
-void writeCSVFiles(vector<vector<Benchmark>> &allBenchmarkData)
+void openCheckpoint()
 {
-    string timeCSV = "time.csv";
-    string resultCSV = "result.csv";
-    string speedupCSV = "speedup.csv";
+    if (checkpointPath.empty())
+        return;
+
+    CheckpointShape shape{
+        .cells = int(selectedFunctions.size() * selectedVariants.size() * threadCounts.size()),
+        .runs = numberOfRuns,
+        .threadSlots = *max_element(threadCounts.begin(), threadCounts.end()),
+        .population = populationSize,
+        .dim = 0,
+    };
 
-    ofstream timeFile(timeCSV);
-    ofstream resultFile(resultCSV);
-    ofstream speedupFile(speedupCSV);
+    for (const FunctionBenchmark &func : selectedFunctions)
+        shape.dim = max(shape.dim, func.dim);
 
-    timeFile << "Function,";
-    resultFile << "Function,";
-    speedupFile << "Function,";
+    checkpoint.open(checkpointPath, shape, sweepFingerprint(), randomSeed, resumeSweep);
 
-    for (int threads = minimumThreads; threads <= numberOfThreads; threads *= 2)
+    if (resumeSweep)
     {
-        timeFile << to_string(threads) + (threads == 1 ? " Thread" : " Threads") + ",";
-        resultFile << to_string(threads) + (threads == 1 ? " Thread" : " Threads") + ",";
-        speedupFile << to_string(threads) + (threads == 1 ? " Thread" : " Threads") + ",";
+        randomSeed = checkpoint.seed();
+        cout << "Resuming " << checkpointPath << ": " << checkpoint.cellsDone() << " of " << shape.cells << " benchmarks done" << endl;
+        cout << endl;
     }
+}
+
+/**
+ * Main function
+ */
+int main(int argc, char *argv[])
+{
+    programArguments.assign(argv, argv + argc);
 
-    if (isNotPowerOfTwoThreads)
+    // Settings come from --key value arguments and --config files, --seed makes every run reproducible
+    try
     {
-        timeFile << to_string(numberOfThreads) + " Threads,";
-        resultFile << to_string(numberOfThreads) + " Threads,";
-        speedupFile << to_string(numberOfThreads) + " Threads,";
-    }
+        if (!configure(argc, argv))
+            return 0;
 
-    timeFile << endl;
-    resultFile << endl;
-    speedupFile << endl;
+        if (!islandWorker.empty())
+            return runIslandWorker(islandWorker, selectedFunctions, threadPlacement);
 
-    for (int i = 0; i < allBenchmarkData.size(); i++)
-    {
-        timeFile << functionBenchmarks[i].name + ",";
-        resultFile << functionBenchmarks[i].name + ",";
-        speedupFile << functionBenchmarks[i].name + ",";
+        objectiveSeed = randomSeed;
 
-        for (int j = 0; j < allBenchmarkData[i].size(); j++)
+        if (tuneMode)
         {
-            timeFile << allBenchmarkData[i][j].time.count() << ",";
-            resultFile << allBenchmarkData[i][j].averageResult << ",";
+            loadTuningProfile(tuningPath, tuningProfile, tuningHostKey, cout);
+
+            maxGenerations = tuneGenerations;
+            randomnessDelta = (randomnessEnd - randomnessStart) / maxGenerations;
+
+            return runTuner({.path = tuningPath,
+                             .functions = selectedFunctions,
+                             .variants = selectedVariants,
+                             .threadCounts = threadCounts,
+                             .schedules = tuneSchedules,
+                             .chunks = tuneChunks,
+                             .runs = tuneRuns,
+                             .seed = randomSeed},
+                            tuningProfile, tuningHostKey);
+        }
 
-            double speedup = allBenchmarkData[i][0].time / allBenchmarkData[i][j].time;
-            speedupFile << speedup << ",";
+        // Jobs write their results to stdout
+        loadTuningProfile(tuningPath, tuningProfile, tuningHostKey, serviceInput.empty() ? cout : cerr);
+
+        if (!serviceInput.empty())
+        {
+            // Jobs of several workers share the CPUs, pinning every team to the same slots would stack them up
+            threadPlacement.clear();
+
+            return runService({.input = serviceInput,
+                               .threads = serviceThreads,
+                               .functions = functionBenchmarks,
+                               .variants = variants,
+                               .func = selectedFunctions.front(),
+                               .variant = findByName(variants, serviceVariant, "variant"),
+                               .fixedDimensionFunctions = fixedDimensionFunctions,
+                               .seed = randomSeed,
+                               .tuned = tunedSetting});
         }
 
-        timeFile << endl;
-        resultFile << endl;
-        speedupFile << endl;
+        openCheckpoint();
+    }
+    catch (const exception &error)
+    {
+        cerr << "Error: " << error.what() << endl;
+        cerr << "Run with --help to list the settings" << endl;
+        return 1;
     }
 
-    timeFile.close();
-    resultFile.close();
-    speedupFile.close();
-}
+    objectiveSeed = randomSeed;
+
+    // Before the first parallel region, so the counters are inherited by every OpenMP thread
+    if (countHardwareEvents && !hardwareCounters.open())
+        cerr << "Hardware counters are not available, perf_event_open failed" << endl;
+
+    printTopology(readTopology());
 
-/**
- * Main function
- */
-int main()
-{
     // Measure the total execution time
     auto start = chrono::high_resolution_clock::now();
 
-    printTableTitle("Speed Table", 2, 1);
+    // Thread counts the tuner picked for this host, next to the fastest of the sweep
+    const bool tunedColumn = tuningProfile.count(tuningHostKey) > 0;
+
+    printTableTitle("Speed Table", 2, tunedColumn ? 2 : 1);
     printTableHeader();
     printElement("Best", numWidth);
+
+    if (tunedColumn)
+        printElement("Tuned", numWidth);
+
     cout << endl;
     cout << endl;
 
     vector<vector<Benchmark>> allBenchmarkData;
+    int cell = 0;
 
-    // Run the Firefly Algorithm for each function
-    for (const auto &funcBenchmark : functionBenchmarks)
+    // Run the Firefly Algorithm for each function and variant
+    for (const auto &funcBenchmark : selectedFunctions)
     {
-        vector<Benchmark> benchmarkData;
-        string function_name = funcBenchmark.name;
+        for (const auto &variant : selectedVariants)
+        {
+            vector<Benchmark> benchmarkData;
 
-        printElement(function_name, nameWidth);
+            printElement(funcBenchmark.name + " " + variant.name, nameWidth);
 
-        // Execute the benchmark for each number of threads
-        for (int threads = minimumThreads; threads <= numberOfThreads; threads *= 2)
-        {
-            Benchmark bench = executeBenchmark(funcBenchmark, threads);
-            printElementPrecise(bench.time, numWidth);
-            benchmarkData.push_back(bench);
+            // Execute the benchmark for each number of threads
+            for (int threads : threadCounts)
+            {
+                Benchmark bench = executeBenchmark(funcBenchmark, variant, threads, cell++);
+                printElementPrecise(bench.time, numWidth);
+                benchmarkData.push_back(bench);
+            }
+
+            allBenchmarkData.push_back(benchmarkData);
+
+            // Find the best time
+            auto min_element_it = min_element(benchmarkData.begin(), benchmarkData.end(), [](const Benchmark &a, const Benchmark &b) {
+                return a.time < b.time;
+            });
+
+            int best_index = distance(benchmarkData.begin(), min_element_it);
+
+            printElement(threadLabel(benchmarkData[best_index].threadCount), numWidth);
+
+            if (tunedColumn)
+            {
+                const optional<TunedSetting> tuned = tunedSetting(funcBenchmark, variant);
+                printElement(tuned ? threadLabel(tuned->threads) : "-", numWidth);
+            }
+
+            cout << endl;
         }
+    }
+
+    printHybridNotes();
+    printDeferredNotes();
+
+    cout << endl;
+    cout << endl;
+
+    vector<vector<Benchmark>> weakBenchmarkData;
+
+    // Weak scaling, the same rows again with the problem growing with the thread count
+    if (scalingStudy)
+    {
+        printTableTitle("Weak Scaling Speed Table");
+        printTableHeader();
+        cout << endl;
+        cout << endl;
 
-        // If the max threads is not a power of two, run a benchmark for it
-        if (isNotPowerOfTwoThreads)
+        for (const auto &funcBenchmark : selectedFunctions)
         {
-            Benchmark bench = executeBenchmark(funcBenchmark, numberOfThreads);
-            printElementPrecise(bench.time, numWidth);
-            benchmarkData.push_back(bench);
+            for (const auto &variant : selectedVariants)
+            {
+                printElement(funcBenchmark.name + " " + variant.name, nameWidth);
+
+                weakBenchmarkData.push_back(executeWeakScaling(funcBenchmark, variant));
+
+                for (const Benchmark &bench : weakBenchmarkData.back())
+                    printElementPrecise(bench.time, numWidth);
+
+                cout << endl;
+            }
         }
 
-        allBenchmarkData.push_back(benchmarkData);
+        cout << endl;
+        cout << endl;
+    }
 
-        // Find the best time
-        auto min_element_it = min_element(benchmarkData.begin(), benchmarkData.end(), [](const Benchmark &a, const Benchmark &b) {
-            return a.time < b.time;
-        });
+    vector<vector<Benchmark>> populationBenchmarkData;
 
-        int best_index = distance(benchmarkData.begin(), min_element_it);
+    // Population comparison, the same rows again at every population size
+    if (!neighbourPopulations.empty())
+    {
+        printTableTitle("Population Speed Table (" + threadLabel(threadCounts.back()) + ")", 2, (int)neighbourPopulations.size() - (int)threadCounts.size());
+        printElement("Function", nameWidth);
 
-        printElement(to_string(benchmarkData[best_index].threadCount) + (benchmarkData[best_index].threadCount == 1 ? " Thread" : " Threads"), numWidth);
+        for (int population : neighbourPopulations)
+            printElement("N = " + to_string(population), numWidth);
 
         cout << endl;
-    }
+        cout << endl;
 
-    cout << endl;
-    cout << endl;
+        for (const auto &funcBenchmark : selectedFunctions)
+        {
+            for (const auto &variant : selectedVariants)
+            {
+                printElement(funcBenchmark.name + " " + variant.name, nameWidth);
+
+                populationBenchmarkData.push_back(executePopulationSweep(funcBenchmark, variant));
+
+                for (const Benchmark &bench : populationBenchmarkData.back())
+                    printElementPrecise(bench.time, numWidth);
+
+                cout << endl;
+            }
+        }
+
+        cout << endl;
+        cout << endl;
+    }
 
     // Print the rest of the tables
     printSpeedupTable(allBenchmarkData);
+    printSpeedupIntervalTable(allBenchmarkData);
+    printVariantSpeedupTable(allBenchmarkData);
+    printMedianTimeTable(allBenchmarkData);
+    printCpuTimeTable(allBenchmarkData);
     printResultsTable(allBenchmarkData);
     printBestResultsTable(allBenchmarkData);
+    printRngTimeTable(allBenchmarkData);
+    printSyncTimeTable(allBenchmarkData);
+    printSchedulerTable(allBenchmarkData);
+    printPhaseTable(allBenchmarkData);
+    printCounterTable(allBenchmarkData);
+    printEvaluationsTable(allBenchmarkData);
+
+    if (deferredEvaluationSelected())
+        printDeferredTables(allBenchmarkData);
+
+    printTargetTables(allBenchmarkData);
+
+    if (scalingStudy)
+        printScalingTables(allBenchmarkData, weakBenchmarkData);
+
+    if (!populationBenchmarkData.empty())
+        printPopulationTables(populationBenchmarkData);
+
+    if (reducedPrecisionSelected())
+        printPrecisionTables(allBenchmarkData);
 
     writeCSVFiles(allBenchmarkData);
+    writeSchedulerCSV(allBenchmarkData);
+    writePhaseCSV(allBenchmarkData);
+    writeSamplesCSV(allBenchmarkData);
+    writeJSONFile(allBenchmarkData);
+
+    if (scalingStudy)
+        writeScalingCSV(allBenchmarkData, weakBenchmarkData);
+
+    if (!populationBenchmarkData.empty())
+        writePopulationCSV(populationBenchmarkData);
+
+    if (reducedPrecisionSelected())
+        writePrecisionCSV(allBenchmarkData);
 
     // Calculate the total execution time
     auto end = chrono::high_resolution_clock::now();
@@ -435,6 +3879,9 @@ int main()
     // Print the total execution time
     cout << "Total execution time: " << elapsed;
 
+    cout << endl;
+    cout << "Seed: " << randomSeed;
+
     cout << endl;
     cout << endl;
 
@@ -3,23 +3,360 @@
 #include <functional>
 #include <string>
 #include <chrono>
+#include <span>
+#include <array>
+#include <optional>
 
 using namespace std;
 
+/**
+ * Scores count candidates stored dimension-major (coordinate k of candidate c at x[k * stride + c]) into out
+ */
+using BatchFunction = function<void(const double *x, size_t stride, int count, int dim, double *out)>;
+
+struct FunctionBenchmark;
+struct FireflyOptions;
+struct FireflyResult;
+class IslandLink;
+class Checkpoint;
+
+/**
+ * Optimizer instantiated at compile time for one objective function and dimension
+ */
+using SpecializedFirefly = FireflyResult (*)(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run);
+
+/**
+ * Known global minimum of a function at a dimension, nullopt where none is known
+ */
+using OptimumFunction = optional<double> (*)(int dim);
+
 struct FunctionBenchmark
 {
     int dim;
     double min_range;
     double max_range;
+    // Known global minimum at a dimension, the target of the time-to-target telemetry, so it follows every change of dim
+    OptimumFunction optimum;
     string name;
-    function<double(const vector<double> &)> benchmark;
+    function<double(span<const double>)> benchmark;
+    // The same function computed in single precision
+    function<float(span<const float>)> singleBenchmark;
+    BatchFunction batchBenchmark;
+    SpecializedFirefly specialized;
+};
+
+enum class PopulationLayout
+{
+    AoS,
+    SoA
+};
+
+/**
+ * Scalar types of a run, the one positions and noise are stored in and the one distances, moves and the objective
+ * are computed in. Fitness is a double in every mode.
+ */
+enum class Precision
+{
+    Double,
+    // Float storage and arithmetic
+    Single,
+    // Float storage, double arithmetic
+    Mixed
+};
+
+enum class NoiseMode
+{
+    Inline,
+    Bulk
+};
+
+enum class ParallelStrategy
+{
+    // Runs one after another, threads share the fireflies of a run
+    IntraRun,
+    // Independent runs spread over the threads, one thread per run
+    InterRun,
+    // Runs spread over groups of threads, each group shares the fireflies of its run
+    Hybrid
+};
+
+enum class UpdateMode
+{
+    // Fireflies move inside the live population while others read it
+    InPlace,
+    // Every firefly reads the previous generation and writes a second buffer, swapped once per generation
+    Synchronous,
+    // Synchronous, but every firefly moves once by the averaged pull of all brighter fireflies plus one noise term,
+    // computed over tiles of the i x j interaction space by a work-stealing scheduler
+    Tiled
+};
+
+enum class ThreadTeam
+{
+    // A new parallel region every generation
+    ForkJoin,
+    // One parallel region per run, generations separated by a SpinBarrier
+    Persistent
+};
+
+/**
+ * OpenMP schedule of the fork-join loop over the fireflies
+ */
+enum class LoopSchedule
+{
+    Static,
+    Dynamic,
+    Guided
+};
+
+enum class BarrierWait
+{
+    Spin,
+    SpinYield,
+    Futex
+};
+
+enum class DistanceMetric
+{
+    // Share of exactly equal coordinates, the original metric kept for comparison
+    Legacy,
+    // r is the Euclidean distance, taken with a square root and squared again for the attractiveness
+    Euclidean,
+    // The sum of squared differences, which is the r² of the attractiveness, the Euclidean result without the root
+    SquaredEuclidean
+};
+
+/**
+ * Which fireflies a firefly is compared with every generation
+ */
+enum class Neighbourhood
+{
+    // Every other firefly, O(N²) pairs per generation
+    All,
+    // The k brightest fireflies of the generation
+    Brightest,
+    // The k nearest, found through an approximate index of random projections
+    Nearest,
+    // k fireflies drawn at random every generation
+    Sampled
+};
+
+/**
+ * When a moved firefly is scored
+ * Scoring less often saves evaluations, but until it is scored a firefly compares against its stale brightness
+ * and keeps moving towards fireflies it has already overtaken. The deferred policies are different algorithms
+ * that converge far more slowly per generation, not cheaper schedules of the per-move one.
+ */
+enum class EvaluationPolicy
+{
+    // Score a firefly after every move towards a brighter one
+    PerMove,
+    // Score a firefly once per generation, after all its moves
+    PerGeneration,
+    // Score a firefly after every evaluationInterval moves and after its last move
+    EveryKMoves
+};
+
+enum class MigrationTopology
+{
+    // A single swarm, no islands
+    None,
+    // Every island sends to the next one
+    Ring,
+    // Every island sends to all others
+    Full
+};
+
+enum class IslandTransport
+{
+    // Islands are concurrent teams of this process
+    Threads,
+    // Islands are separate processes of this program sharing memory with the run
+    Processes
+};
+
+struct FireflyOptions
+{
+    PopulationLayout layout = PopulationLayout::AoS;
+    Precision precision = Precision::Double;
+    // Score all moved fireflies once per generation through the function's batch entry point. A deferred-evaluation
+    // algorithm: every comparison of the generation uses the brightness of its start, so it needs far more generations
+    // to reach the per-move results, not a faster way to them
+    bool batchEvaluation = false;
+    // Use the compile-time specialized instance when the function has one for its dimension
+    bool specialized = true;
+    // Master seed of the counter-based random streams, together with the run index it fixes every draw
+    uint64_t seed = 0;
+    // Draw movement noise one value at a time inside the update, or generate the noise of each move into a per-thread
+    // buffer in one vectorized pass
+    NoiseMode noise = NoiseMode::Bulk;
+    ParallelStrategy strategy = ParallelStrategy::IntraRun;
+    // Firefly-level threads of every run in the hybrid strategy, the rest of the budget goes to concurrent runs
+    int hybridFireflyThreads = 4;
+    UpdateMode update = UpdateMode::InPlace;
+    ThreadTeam team = ThreadTeam::ForkJoin;
+    BarrierWait barrierWait = BarrierWait::SpinYield;
+    // How the fork-join loop shares out the fireflies, usually left to the tuning profile
+    LoopSchedule schedule = LoopSchedule::Dynamic;
+    int chunkSize = 1;
+    // Fireflies per side of an interaction tile in tiled mode
+    int tileSize = 8;
+    DistanceMetric distance = DistanceMetric::Legacy;
+    // Synchronous mode: compute the attractiveness of every pair once per generation as a blocked matrix
+    // instead of per pair from the moving firefly, tiled mode always computes it per tile
+    bool distanceMatrix = false;
+    // Bounded neighbour sets make a generation O(N k) instead of O(N²), tiled mode always compares all pairs
+    Neighbourhood neighbourhood = Neighbourhood::All;
+    // Trades evaluations for solution quality, the sweep reports both for the deferred policies.
+    // Ignored with batch evaluation, which always scores once per generation
+    EvaluationPolicy evaluation = EvaluationPolicy::PerMove;
+    int evaluationInterval = 4;
+    // A run reaches its target when its best fitness is within targetGap of the function's optimum
+    double targetGap = 1e-2;
+    // Stopping criteria, checked after every generation, each one is off by default
+    bool stopAtTarget = false;
+    // Generations without improving the best fitness
+    int stagnationGenerations = 0;
+    double timeBudgetSeconds = 0.0;
+    long evaluationBudget = 0;
+    // Island model: several swarms of populationSize fireflies exchanging their best fireflies along the topology
+    MigrationTopology topology = MigrationTopology::None;
+    IslandTransport transport = IslandTransport::Threads;
+    // Set for each island of an island run, its channels to the other islands
+    IslandLink *island = nullptr;
+    // Where a run saves its state between generations and resumes from, null when runs are not checkpointed
+    Checkpoint *checkpoint = nullptr;
+};
+
+/**
+ * When a run first reached its target
+ */
+struct TargetTelemetry
+{
+    bool hit = false;
+    int generation = 0;
+    long evaluations = 0;
+    // Wall time since the run started, initialization included
+    double seconds = 0.0;
+};
+
+/**
+ * What one thread of the work-stealing scheduler did
+ */
+struct SchedulerStats
+{
+    long tiles = 0;
+    long steals = 0;
+    // Time spent with an empty deque looking for work to steal
+    double idleSeconds = 0.0;
+};
+
+/**
+ * Phases of a run the phase timers charge time to
+ */
+enum class Phase
+{
+    // Placing the initial fireflies
+    Init,
+    // Distances and attractiveness of the pairs
+    Distance,
+    // Moving the fireflies, movement noise included
+    Movement,
+    // Objective evaluations
+    Evaluation,
+    // Barrier waits, idle scheduler threads and the serial work between generations
+    Sync
+};
+
+const int phaseCount = 5;
+
+/**
+ * Seconds one thread spent in every phase
+ */
+using PhaseTimes = array<double, phaseCount>;
+
+/**
+ * Hardware events counted over the timed runs of a benchmark, all threads together
+ */
+struct HardwareCounters
+{
+    bool valid = false;
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double cacheMisses = 0.0;
+    double branchMisses = 0.0;
+};
+
+struct FireflyResult
+{
+    double bestFitness;
+    // Time spent generating bulk noise, summed over threads
+    double rngSeconds;
+    // Time threads spent waiting at the end of generations, summed over threads
+    double syncSeconds;
+    // One entry per thread in tiled mode, empty otherwise
+    vector<SchedulerStats> scheduler;
+    // Objective evaluations of the run, including the initial population
+    long evaluations;
+    // Generations actually run, fewer than maxGenerations when a stopping criterion fired
+    int generations;
+    TargetTelemetry target;
+    // Time per phase of every firefly-level thread, empty when the phase timers are compiled out
+    vector<PhaseTimes> phases;
+    // Fireflies taken in from other islands
+    long migrants = 0;
+};
+
+/**
+ * Summary of a set of timing samples
+ */
+struct SampleStatistics
+{
+    double median = 0.0;
+    double min = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+};
+
+struct Variant
+{
+    string name;
+    FireflyOptions options;
 };
 
 struct Benchmark
 {
     int threadCount;
     string functionName;
+    string variantName;
     chrono::duration<double> time;
+    chrono::duration<double> rngTime;
+    chrono::duration<double> syncTime;
+    // Scheduler statistics per firefly-level thread, summed over runs
+    vector<SchedulerStats> scheduler;
+    // Average objective evaluations per run
+    double evaluations;
+    double generations;
+    // Runs that reached the target, and their average time and evaluations to get there (NaN when none did)
+    int targetHits;
+    chrono::duration<double> timeToTarget;
+    double evaluationsToTarget;
     double averageResult;
     double bestResult;
-};
\ No newline at end of file
+    // Per-run wall time divided by the runs executing at once, and the best fitness of every run
+    vector<double> samples;
+    vector<double> results;
+    SampleStatistics timing;
+    // Process CPU time per run, all threads included
+    chrono::duration<double> cpuTime;
+    // Phase times per firefly-level thread and run, and the hardware events per run
+    vector<PhaseTimes> phases;
+    HardwareCounters counters;
+    // Average fireflies per run that migrated into an island and replaced a worse one
+    double migrants;
+};
+/**
+ * Run the Firefly Algorithm once, run is the index of the run within its benchmark
+ * Defined with the optimizer, the modules that drive runs of their own call it through this declaration
+ */
+FireflyResult fireflyAlgorithm(const FunctionBenchmark &func, int numThreads, const FireflyOptions &options, int run);
@@ -4,6 +4,9 @@
 #include <cstdlib>
 #include <numeric>
 #include <random>
+#include <span>
+#include "simd_math.cpp"
+#include "random.cpp"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -15,66 +18,79 @@
 
 using namespace std;
 
-double sumSquares(const vector<double>& x) {
-    double sum = 0.0;
+/**
+ * Integer powers of a float stay in single precision, the standard overload would promote them to double
+ */
+inline float pow(float base, int exponent) {
+    return powf(base, float(exponent));
+}
+
+template <typename T>
+T sumSquares(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size(); ++i) {
         sum += (i + 1) * x[i] * x[i];
     }
     return sum;
 }
 
-double step2(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
+template <typename T>
+T step2(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
         sum += pow(xi + 0.5, 2);
     }
     return sum;
 }
 
-double quartic(const vector<double>& x) {
-    static thread_local mt19937 rng(random_device{}());
-    static thread_local uniform_real_distribution<double> dist(0.0, 1.0);
-    
-    double sum = 0.0;
+template <typename T>
+T quartic(span<const T> x) {
+    const RandomStream noise = objectiveNoise(x.data(), 1, x.size());
+
+    T sum = 0.0;
     for (size_t i = 0; i < x.size(); ++i) {
-        sum += (i + 1) * pow(x[i], 4) + dist(rng);
+        sum += (i + 1) * pow(x[i], 4) + noise.uniform(i);
     }
     return sum;
 }
 
-double powell(const vector<double>& x) {
-    double sum = 0.0;
+template <typename T>
+T powell(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size() / 4; ++i) {
-        double term1 = pow(x[4 * i - 3] + 10 * x[4 * i - 2], 2);
-        double term2 = 5 * pow(x[4 * i - 1] + x[4 * i], 2);
-        double term3 = pow(x[4 * i - 2] + x[4 * i - 1], 4);
-        double term4 = 10 * pow(x[4 * i - 3] + x[4 * i], 4);
+        T term1 = pow(x[4 * i] + 10 * x[4 * i + 1], 2);
+        T term2 = 5 * pow(x[4 * i + 2] + x[4 * i + 3], 2);
+        T term3 = pow(x[4 * i + 1] + x[4 * i + 2], 4);
+        T term4 = 10 * pow(x[4 * i] + x[4 * i + 3], 4);
         sum += term1 + term2 + term3 + term4;
     }
     return sum;
 }
 
-double rosenbrock(const vector<double>& x) {
-    double sum = 0.0;
+template <typename T>
+T rosenbrock(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size() - 1; ++i) {
         sum += 100 * pow(x[i + 1] - x[i] * x[i], 2) + pow(x[i] - 1, 2);
     }
     return sum;
 }
 
-double dixonPrice(const vector<double>& x) {
-    double term1 = pow(x[0] - 1, 2);
-    double sum = term1;
+template <typename T>
+T dixonPrice(span<const T> x) {
+    T term1 = pow(x[0] - 1, 2);
+    T sum = term1;
     for (size_t i = 1; i < x.size(); ++i) {
         sum += i * pow(2 * x[i] * x[i] - x[i - 1], 2);
     }
     return sum;
 }
 
-double schwefel1_2(const vector<double>& x) {
-    double sum = 0.0;
+template <typename T>
+T schwefel1_2(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size(); ++i) {
-        double innerSum = 0.0;
+        T innerSum = 0.0;
         for (size_t j = 0; j <= i; ++j) {
             innerSum += x[j];
         }
@@ -83,66 +99,75 @@ double schwefel1_2(const vector<double>& x) {
     return sum;
 }
 
-double schwefel2_20(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
+template <typename T>
+T schwefel2_20(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
         sum += fabs(xi);
     }
     return sum;
 }
 
-double schwefel2_21(const vector<double>& x) {
-    double maxVal = fabs(x[0]);
-    for (double xi : x) {
+template <typename T>
+T schwefel2_21(span<const T> x) {
+    T maxVal = fabs(x[0]);
+    for (T xi : x) {
         maxVal = max(maxVal, fabs(xi));
     }
     return maxVal;
 }
 
-double rastrigin(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
-        sum += xi * xi - 10 * cos(2 * M_PI * xi) + 10;
+template <MathMode Mode, typename T>
+T rastriginWith(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
+        sum += xi * xi - 10 * scalarCos<Mode>(T(2 * M_PI) * xi) + 10;
     }
     return sum;
 }
 
-double griewank(const vector<double>& x) {
-    double sum = 0.0;
-    double product = 1.0;
+template <MathMode Mode, typename T>
+T griewankWith(span<const T> x) {
+    T sum = 0.0;
+    T product = 1.0;
     for (size_t i = 0; i < x.size(); ++i) {
         sum += x[i] * x[i] / 4000.0;
-        product *= cos(x[i] / sqrt(i + 1));
+        product *= scalarCos<Mode>(x[i] / sqrt(i + 1));
     }
     return sum - product + 1;
 }
 
-double csendes(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
-        sum += pow(xi, 6) * (2 + sin(1 / xi));
+template <MathMode Mode, typename T>
+T csendesWith(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
+        sum += pow(xi, 6) * (2 + scalarSin<Mode>(1 / xi));
     }
     return sum;
 }
 
-double colville(const vector<double>& x) {
+template <typename T>
+T colville(span<const T> x) {
     return 100 * pow(x[1] - pow(x[0], 2), 2) + pow(x[0] - 1, 2) + pow(x[2] - 1, 2) +
            90 * pow(x[3] - x[2], 2) + 10.1 * (pow(x[1] - 1, 2) + pow(x[3] - 1, 2)) + 19.8 * (x[1] - 1) * (x[3] - 1);
 }
 
-double easom(const vector<double>& x) {
-    return -cos(x[0]) * cos(x[1]) * exp(-pow(x[0] - M_PI, 2) - pow(x[1] - M_PI, 2));
+template <MathMode Mode, typename T>
+T easomWith(span<const T> x) {
+    return -scalarCos<Mode>(x[0]) * scalarCos<Mode>(x[1]) * scalarExp<Mode>(-pow(x[0] - M_PI, 2) - pow(x[1] - M_PI, 2));
 }
 
-double michalewicz(const vector<double>& x) {
-    double sum = 0.0;
+template <MathMode Mode, typename T>
+T michalewiczWith(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size(); ++i) {
-        sum += sin(x[i]) * pow(sin((i + 1) * pow(x[i], 2) / M_PI), 20);
+        sum += scalarSin<Mode>(x[i]) * pow(scalarSin<Mode>((i + 1) * pow(x[i], 2) / M_PI), 20);
     }
     return -sum;
 }
 
-double shekel(const vector<double>& x) {
+template <typename T>
+T shekel(span<const T> x) {
     const double a[10][4] = {
         {4.0, 4.0, 4.0, 4.0}, {1.0, 1.0, 1.0, 1.0}, {8.0, 8.0, 8.0, 8.0}, {6.0, 6.0, 6.0, 6.0},
         {3.0, 7.0, 3.0, 7.0}, {2.0, 9.0, 2.0, 9.0}, {5.0, 5.0, 3.0, 3.0}, {8.0, 1.0, 8.0, 1.0},
@@ -150,9 +175,9 @@ double shekel(const vector<double>& x) {
     };
     const double c[10] = {0.1, 0.2, 0.2, 0.4, 0.4, 0.6, 0.3, 0.7, 0.5, 0.5};
     
-    double sum = 0.0;
+    T sum = 0.0;
     for (int i = 0; i < 10; ++i) {
-        double inner_sum = 0.0;
+        T inner_sum = 0.0;
         for (int j = 0; j < 4; ++j) {
             inner_sum += pow(x[j] - a[i][j], 2);
         }
@@ -161,65 +186,440 @@ double shekel(const vector<double>& x) {
     return -sum;
 }
 
-double schwefel2_4(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
+template <typename T>
+T schwefel2_4(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
         sum += pow(xi - 1, 2) + pow(xi - xi, 2);
     }
     return sum;
 }
 
-double schwefel(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
-        sum += -xi * sin(sqrt(fabs(xi)));
+template <MathMode Mode, typename T>
+T schwefelWith(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
+        sum += -xi * scalarSin<Mode>(scalarSqrt<Mode>(fabs(xi)));
     }
     return sum;
 }
 
-double schaffer(const vector<double>& x) {
-    double sum = 0.0;
+template <MathMode Mode, typename T>
+T schafferWith(span<const T> x) {
+    T sum = 0.0;
     for (size_t i = 0; i < x.size() - 1; ++i) {
-        double xi = x[i];
-        double xj = x[i + 1];
-        sum += 0.5 + (pow(sin(sqrt(xi * xi + xj * xj)), 2) - 0.5) / pow(1 + 0.001 * (xi * xi + xj * xj), 2);
+        T xi = x[i];
+        T xj = x[i + 1];
+        sum += 0.5 + (pow(scalarSin<Mode>(scalarSqrt<Mode>(xi * xi + xj * xj)), 2) - 0.5) / pow(1 + 0.001 * (xi * xi + xj * xj), 2);
     }
     return sum;
 }
 
-double alpine(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
-        sum += fabs(xi * sin(xi) + 0.1 * xi);
+template <MathMode Mode, typename T>
+T alpineWith(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
+        sum += fabs(xi * scalarSin<Mode>(xi) + 0.1 * xi);
     }
     return sum;
 }
 
-double ackley(const vector<double>& x) {
-    double sum1 = 0.0;
-    double sum2 = 0.0;
-    for (double xi : x) {
+template <MathMode Mode, typename T>
+T ackleyWith(span<const T> x) {
+    T sum1 = 0.0;
+    T sum2 = 0.0;
+    for (T xi : x) {
         sum1 += xi * xi;
-        sum2 += cos(2 * M_PI * xi);
+        sum2 += scalarCos<Mode>(T(2 * M_PI) * xi);
     }
-    double n = static_cast<double>(x.size());
-    return -20.0 * exp(-0.2 * sqrt(sum1 / n)) - exp(sum2 / n) + 20.0 + M_E;
+    T n = static_cast<T>(x.size());
+    return -20.0 * scalarExp<Mode>(-0.2 * scalarSqrt<Mode>(sum1 / n)) - scalarExp<Mode>(sum2 / n) + 20.0 + M_E;
 }
 
-double sphere(const vector<double>& x) {
-    double sum = 0.0;
-    for (double xi : x) {
+template <typename T>
+T sphere(span<const T> x) {
+    T sum = 0.0;
+    for (T xi : x) {
         sum += xi * xi;
     }
     return sum;
 }
 
-double schwefel2_22(const vector<double>& x) {
-    double sum = 0.0;
-    double product = 1.0;
-    for (double xi : x) {
+template <typename T>
+T schwefel2_22(span<const T> x) {
+    T sum = 0.0;
+    T product = 1.0;
+    for (T xi : x) {
         sum += fabs(xi);
         product *= fabs(xi);
     }
     return sum + product;
 }
+
+/**
+ * Functions calling sin, cos, exp or sqrt are written once against the math layer and instantiated per math mode,
+ * name##With<MathMode::Libm> is the plain libm version the other modes are checked against
+ * Every scalar function is templated on the scalar type it computes in, double or float
+ */
+
+#define DEFINE_MATH_SCALAR(name)                                                             \
+    template <typename T>                                                                    \
+    T name(span<const T> x) {                                                                \
+        switch (mathMode) {                                                                  \
+        case MathMode::Precise: return name##With<MathMode::Precise>(x);                     \
+        case MathMode::Fast: return name##With<MathMode::Fast>(x);                           \
+        default: return name##With<MathMode::Libm>(x);                                       \
+        }                                                                                    \
+    }
+
+DEFINE_MATH_SCALAR(rastrigin)
+DEFINE_MATH_SCALAR(griewank)
+DEFINE_MATH_SCALAR(csendes)
+DEFINE_MATH_SCALAR(easom)
+DEFINE_MATH_SCALAR(michalewicz)
+DEFINE_MATH_SCALAR(schwefel)
+DEFINE_MATH_SCALAR(schaffer)
+DEFINE_MATH_SCALAR(alpine)
+DEFINE_MATH_SCALAR(ackley)
+
+/**
+ * Batched evaluation
+ *
+ * Every function also has a batch entry point name##Batch(x, stride, count, dim, out) scoring count candidates at once.
+ * Candidates are stored dimension-major: coordinate k of candidate c is x[k * stride + c].
+ * The kernels below are written once against the SimdDouble interface, so each SIMD lane scores its own candidate,
+ * and leftover candidates go through the same kernel instantiated for ScalarDouble.
+ */
+
+#define DEFINE_BATCH(name)                                                                   \
+    void name##Batch(const double *x, size_t stride, int count, int dim, double *out) {      \
+        int c = 0;                                                                           \
+        for (; c + SimdDouble::width <= count; c += SimdDouble::width)                       \
+            name##Kernel<SimdDouble>(x + c, stride, dim).store(out + c);                     \
+        for (; c < count; ++c)                                                               \
+            name##Kernel<ScalarDouble>(x + c, stride, dim).store(out + c);                   \
+    }
+
+/**
+ * Kernels calling the math layer are instantiated once per math mode, the mode is picked per call
+ */
+#define DEFINE_MATH_BATCH(name)                                                              \
+    template <MathMode Mode>                                                                 \
+    void name##BatchWith(const double *x, size_t stride, int count, int dim, double *out) {  \
+        int c = 0;                                                                           \
+        for (; c + SimdDouble::width <= count; c += SimdDouble::width)                       \
+            name##Kernel<SimdDouble, Mode>(x + c, stride, dim).store(out + c);               \
+        for (; c < count; ++c)                                                               \
+            name##Kernel<ScalarDouble, Mode>(x + c, stride, dim).store(out + c);             \
+    }                                                                                        \
+    void name##Batch(const double *x, size_t stride, int count, int dim, double *out) {      \
+        switch (mathMode) {                                                                  \
+        case MathMode::Precise: return name##BatchWith<MathMode::Precise>(x, stride, count, dim, out); \
+        case MathMode::Fast: return name##BatchWith<MathMode::Fast>(x, stride, count, dim, out);       \
+        default: return name##BatchWith<MathMode::Libm>(x, stride, count, dim, out);                  \
+        }                                                                                    \
+    }
+
+template <typename V>
+V sumSquaresKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum = fma(V(k + 1.0) * xi, xi, sum);
+    }
+    return sum;
+}
+DEFINE_BATCH(sumSquares)
+
+template <typename V>
+V step2Kernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        sum = sum + square(V::load(x + k * stride) + V(0.5));
+    }
+    return sum;
+}
+DEFINE_BATCH(step2)
+
+template <typename V>
+V quarticKernel(const double *x, size_t stride, int dim) {
+    // Same per-point noise streams as the scalar version, one per lane
+    RandomStream noise[V::width];
+    for (int l = 0; l < V::width; ++l) {
+        noise[l] = objectiveNoise(x + l, stride, dim);
+    }
+
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        alignas(64) double draws[V::width];
+        for (int l = 0; l < V::width; ++l) {
+            draws[l] = noise[l].uniform(k);
+        }
+        sum = sum + fma(V(k + 1.0), ipow<4>(V::load(x + k * stride)), V::load(draws));
+    }
+    return sum;
+}
+DEFINE_BATCH(quartic)
+
+template <typename V>
+V powellKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int i = 0; i < dim / 4; ++i) {
+        V x1 = V::load(x + (4 * i) * stride);
+        V x2 = V::load(x + (4 * i + 1) * stride);
+        V x3 = V::load(x + (4 * i + 2) * stride);
+        V x4 = V::load(x + (4 * i + 3) * stride);
+        V term1 = square(fma(V(10.0), x2, x1));
+        V term2 = V(5.0) * square(x3 + x4);
+        V term3 = ipow<4>(x2 + x3);
+        V term4 = V(10.0) * ipow<4>(x1 + x4);
+        sum = sum + term1 + term2 + term3 + term4;
+    }
+    return sum;
+}
+DEFINE_BATCH(powell)
+
+template <typename V>
+V rosenbrockKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    V xi = V::load(x);
+    for (int k = 0; k < dim - 1; ++k) {
+        V next = V::load(x + (k + 1) * stride);
+        sum = sum + V(100.0) * square(next - xi * xi) + square(xi - V(1.0));
+        xi = next;
+    }
+    return sum;
+}
+DEFINE_BATCH(rosenbrock)
+
+template <typename V>
+V dixonPriceKernel(const double *x, size_t stride, int dim) {
+    V previous = V::load(x);
+    V sum = square(previous - V(1.0));
+    for (int k = 1; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum = fma(V(k), square(V(2.0) * xi * xi - previous), sum);
+        previous = xi;
+    }
+    return sum;
+}
+DEFINE_BATCH(dixonPrice)
+
+template <typename V>
+V schwefel1_2Kernel(const double *x, size_t stride, int dim) {
+    // Running prefix sum instead of recomputing every inner sum
+    V sum = 0.0;
+    V innerSum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        innerSum = innerSum + V::load(x + k * stride);
+        sum = fma(innerSum, innerSum, sum);
+    }
+    return sum;
+}
+DEFINE_BATCH(schwefel1_2)
+
+template <typename V>
+V schwefel2_20Kernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        sum = sum + abs(V::load(x + k * stride));
+    }
+    return sum;
+}
+DEFINE_BATCH(schwefel2_20)
+
+template <typename V>
+V schwefel2_21Kernel(const double *x, size_t stride, int dim) {
+    V maxVal = abs(V::load(x));
+    for (int k = 1; k < dim; ++k) {
+        maxVal = max(maxVal, abs(V::load(x + k * stride)));
+    }
+    return maxVal;
+}
+DEFINE_BATCH(schwefel2_21)
+
+template <typename V, MathMode Mode>
+V rastriginKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        V cosine = vcos<Mode>(V(2 * M_PI) * xi);
+        sum = sum + fma(xi, xi, V(10.0)) - V(10.0) * cosine;
+    }
+    return sum;
+}
+DEFINE_MATH_BATCH(rastrigin)
+
+template <typename V, MathMode Mode>
+V griewankKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    V product = 1.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum = fma(xi, xi * V(1.0 / 4000.0), sum);
+        product = product * vcos<Mode>(xi * V(1.0 / sqrt(k + 1.0)));
+    }
+    return sum - product + V(1.0);
+}
+DEFINE_MATH_BATCH(griewank)
+
+template <typename V, MathMode Mode>
+V csendesKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        V sine = vsin<Mode>(V(1.0) / xi);
+        sum = fma(ipow<6>(xi), V(2.0) + sine, sum);
+    }
+    return sum;
+}
+DEFINE_MATH_BATCH(csendes)
+
+template <typename V>
+V colvilleKernel(const double *x, size_t stride, int) {
+    V x0 = V::load(x);
+    V x1 = V::load(x + stride);
+    V x2 = V::load(x + 2 * stride);
+    V x3 = V::load(x + 3 * stride);
+    return V(100.0) * square(x1 - x0 * x0) + square(x0 - V(1.0)) + square(x2 - V(1.0)) +
+           V(90.0) * square(x3 - x2) + V(10.1) * (square(x1 - V(1.0)) + square(x3 - V(1.0))) + V(19.8) * (x1 - V(1.0)) * (x3 - V(1.0));
+}
+DEFINE_BATCH(colville)
+
+template <typename V, MathMode Mode>
+V easomKernel(const double *x, size_t stride, int) {
+    V x0 = V::load(x);
+    V x1 = V::load(x + stride);
+    V cosines = vcos<Mode>(x0) * vcos<Mode>(x1);
+    V exponent = V(0.0) - square(x0 - V(M_PI)) - square(x1 - V(M_PI));
+    return V(0.0) - cosines * vexp<Mode>(exponent);
+}
+DEFINE_MATH_BATCH(easom)
+
+template <typename V, MathMode Mode>
+V michalewiczKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        V inner = vsin<Mode>(V((k + 1) / M_PI) * xi * xi);
+        sum = fma(vsin<Mode>(xi), ipow<20>(inner), sum);
+    }
+    return V(0.0) - sum;
+}
+DEFINE_MATH_BATCH(michalewicz)
+
+template <typename V>
+V shekelKernel(const double *x, size_t stride, int) {
+    const double a[10][4] = {
+        {4.0, 4.0, 4.0, 4.0}, {1.0, 1.0, 1.0, 1.0}, {8.0, 8.0, 8.0, 8.0}, {6.0, 6.0, 6.0, 6.0},
+        {3.0, 7.0, 3.0, 7.0}, {2.0, 9.0, 2.0, 9.0}, {5.0, 5.0, 3.0, 3.0}, {8.0, 1.0, 8.0, 1.0},
+        {6.0, 2.0, 6.0, 2.0}, {7.0, 3.6, 7.0, 3.6}
+    };
+    const double c[10] = {0.1, 0.2, 0.2, 0.4, 0.4, 0.6, 0.3, 0.7, 0.5, 0.5};
+
+    V xj[4];
+    for (int j = 0; j < 4; ++j) {
+        xj[j] = V::load(x + j * stride);
+    }
+
+    V sum = 0.0;
+    for (int i = 0; i < 10; ++i) {
+        V inner_sum = c[i];
+        for (int j = 0; j < 4; ++j) {
+            inner_sum = inner_sum + square(xj[j] - V(a[i][j]));
+        }
+        sum = sum + V(1.0) / inner_sum;
+    }
+    return V(0.0) - sum;
+}
+DEFINE_BATCH(shekel)
+
+template <typename V>
+V schwefel2_4Kernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum = sum + square(xi - V(1.0)) + square(xi - xi);
+    }
+    return sum;
+}
+DEFINE_BATCH(schwefel2_4)
+
+template <typename V, MathMode Mode>
+V schwefelKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        V sine = vsin<Mode>(vsqrt<Mode>(abs(xi)));
+        sum = sum - xi * sine;
+    }
+    return sum;
+}
+DEFINE_MATH_BATCH(schwefel)
+
+template <typename V, MathMode Mode>
+V schafferKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    V xi = V::load(x);
+    for (int k = 0; k < dim - 1; ++k) {
+        V xj = V::load(x + (k + 1) * stride);
+        V radius2 = fma(xi, xi, xj * xj);
+        V sine = vsin<Mode>(vsqrt<Mode>(radius2));
+        sum = sum + V(0.5) + (sine * sine - V(0.5)) / square(fma(V(0.001), radius2, V(1.0)));
+        xi = xj;
+    }
+    return sum;
+}
+DEFINE_MATH_BATCH(schaffer)
+
+template <typename V, MathMode Mode>
+V alpineKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        V sine = vsin<Mode>(xi);
+        sum = sum + abs(fma(xi, sine, V(0.1) * xi));
+    }
+    return sum;
+}
+DEFINE_MATH_BATCH(alpine)
+
+template <typename V, MathMode Mode>
+V ackleyKernel(const double *x, size_t stride, int dim) {
+    V sum1 = 0.0;
+    V sum2 = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum1 = fma(xi, xi, sum1);
+        sum2 = sum2 + vcos<Mode>(V(2 * M_PI) * xi);
+    }
+    V n = static_cast<double>(dim);
+    V term1 = vexp<Mode>(V(-0.2) * vsqrt<Mode>(sum1 / n));
+    V term2 = vexp<Mode>(sum2 / n);
+    return V(-20.0) * term1 - term2 + V(20.0 + M_E);
+}
+DEFINE_MATH_BATCH(ackley)
+
+template <typename V>
+V sphereKernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = V::load(x + k * stride);
+        sum = fma(xi, xi, sum);
+    }
+    return sum;
+}
+DEFINE_BATCH(sphere)
+
+template <typename V>
+V schwefel2_22Kernel(const double *x, size_t stride, int dim) {
+    V sum = 0.0;
+    V product = 1.0;
+    for (int k = 0; k < dim; ++k) {
+        V xi = abs(V::load(x + k * stride));
+        sum = sum + xi;
+        product = product * xi;
+    }
+    return sum + product;
+}
+DEFINE_BATCH(schwefel2_22)
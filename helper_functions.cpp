@@ -1,12 +1,24 @@
+#pragma once
+
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <random>
+#include <sstream>
+#include <bit>
+#include <cstdint>
+#include "random.cpp"
 
 using namespace std;
 
 const char separator = ' ';
 
+/**
+ * Table formatting
+ */
+const int nameWidth = 36;
+const int numWidth = 14;
+
 /**
  *
  */
@@ -20,11 +32,11 @@ bool isNotPowerOfTwo(int n)
 }
 
 /**
- * Function to generate random double between min and max using a thread-safe generator
+ * Function to generate random double between min and max from draw number index of a counter-based stream
  */
-double randomDouble(double min, double max, mt19937 &rng, uniform_real_distribution<> &dist)
+double randomDouble(double min, double max, const RandomStream &stream, uint64_t index)
 {
-    return min + dist(rng) * (max - min);
+    return min + stream.uniform(index) * (max - min);
 }
 /**
  * Print an element with a specific width
@@ -53,6 +65,31 @@ void printElementPrecise(T t, const int &width, int precision = 4)
     cout.copyfmt(originalState);
 }
 
+/**
+ * Column label of a thread count
+ */
+string threadLabel(int threads)
+{
+    return to_string(threads) + (threads == 1 ? " Thread" : " Threads");
+}
+
+/**
+ * Print a table title centered over the name column and cells value columns
+ */
+void printTitle(const string &title, int cells, int titlePadding = 2)
+{
+    string newTitle = string(titlePadding, ' ') + title + string(titlePadding, ' ');
+    int titleWidth = newTitle.length();
+
+    int tableWidth = nameWidth + cells * numWidth;
+    int sidePadding = (tableWidth - titleWidth) / 2;
+
+    cout << setfill('=') << setw(sidePadding) << "=";
+    cout << setfill(' ') << setw(titleWidth) << newTitle;
+    cout << setfill('=') << setw(sidePadding) << "=";
+    cout << endl;
+}
+
 /**
  * Calculate the average of a vector of doubles
  */
@@ -66,3 +103,35 @@ double calculateAverage(const std::vector<double> &vec)
 
     return average;
 }
+
+/**
+ * JSON number, null when it is not finite
+ */
+string jsonNumber(double value)
+{
+    // Check the exponent bits, -ffast-math lets the compiler assume isfinite is always true
+    if ((bit_cast<uint64_t>(value) & 0x7ff0000000000000ull) == 0x7ff0000000000000ull)
+        return "null";
+
+    std::ostringstream stream;
+    stream << std::setprecision(17) << value;
+    return stream.str();
+}
+
+/**
+ * JSON string, escaping quotes and backslashes
+ */
+string jsonString(const string &value)
+{
+    string text = "\"";
+
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+            text += '\\';
+
+        text += c;
+    }
+
+    return text + "\"";
+}
@@ -0,0 +1,471 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "population.cpp"
+#include "random.cpp"
+#include "config.cpp"
+
+using namespace std;
+
+/**
+ * Size and exchange pattern of an island run
+ */
+struct IslandShape
+{
+    int islands;
+    int dim;
+    // Fireflies sent per migration and the interval between migrations in generations
+    int migrants;
+    int interval;
+    MigrationTopology topology;
+
+    // Migrants a channel holds before the sender drops new ones
+    int capacity() const
+    {
+        return max(4 * migrants, 8);
+    }
+};
+
+/**
+ * What one island hands back to the run that started it, plain data so a worker process can write it to shared memory
+ */
+struct IslandReport
+{
+    double bestFitness;
+    double rngSeconds;
+    double syncSeconds;
+    long evaluations;
+    int generations;
+    TargetTelemetry target;
+    long migrants;
+};
+
+/**
+ * Fixed part of an arena, the shape, the global best and for worker processes the run they take part in
+ */
+struct IslandHeader
+{
+    IslandShape shape;
+    // Bits of the best fitness any island has reached, lowered with compare-and-swap
+    atomic<uint64_t> globalBest;
+    char function[64];
+    FireflyOptions options;
+    int threads;
+    int run;
+    uint64_t objectiveSeed;
+};
+
+static_assert(is_trivially_copyable_v<FireflyOptions>, "worker processes receive the options as raw bytes");
+static_assert(atomic<uint64_t>::is_always_lock_free, "the global best has to be lock-free to be shared between processes");
+
+/**
+ * Read or write position of a channel, alone on its cache line so sender and receiver do not share one
+ */
+struct alignas(cacheLineSize) ChannelCursor
+{
+    atomic<uint64_t> value;
+};
+
+/**
+ * Memory the islands of one run share: header, one report per island and one single-producer single-consumer
+ * channel per ordered pair of islands. Thread islands keep it on the heap, worker processes in POSIX shared memory.
+ */
+class IslandArena
+{
+public:
+    /**
+     * Arena on the heap, for islands running as threads of this process
+     */
+    explicit IslandArena(const IslandShape &shape) : heap(layoutBytes(shape) / sizeof(double))
+    {
+        base = reinterpret_cast<char *>(heap.data());
+        construct(shape);
+    }
+
+#ifdef __linux__
+    /**
+     * Create the named shared memory arena of a run, or open it in a worker process when shape is null
+     */
+    IslandArena(const string &name, const IslandShape *shape) : name(name), owner(shape != nullptr)
+    {
+        const int fd = shm_open(name.c_str(), owner ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+
+        if (fd < 0)
+            throw runtime_error("cannot open shared memory " + name);
+
+        if (owner)
+        {
+            size = layoutBytes(*shape);
+
+            if (ftruncate(fd, size) != 0)
+            {
+                close(fd);
+                shm_unlink(name.c_str());
+                throw runtime_error("cannot size shared memory " + name);
+            }
+        }
+        else
+        {
+            IslandShape mapped;
+
+            if (pread(fd, &mapped, sizeof(mapped), 0) != sizeof(mapped))
+            {
+                close(fd);
+                throw runtime_error("cannot read shared memory " + name);
+            }
+
+            size = layoutBytes(mapped);
+        }
+
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED)
+        {
+            if (owner)
+                shm_unlink(name.c_str());
+
+            throw runtime_error("cannot map shared memory " + name);
+        }
+
+        base = static_cast<char *>(memory);
+
+        if (owner)
+            construct(*shape);
+    }
+#endif
+
+    IslandArena(const IslandArena &) = delete;
+    IslandArena &operator=(const IslandArena &) = delete;
+
+    ~IslandArena()
+    {
+#ifdef __linux__
+        if (!name.empty())
+        {
+            munmap(base, size);
+
+            if (owner)
+                shm_unlink(name.c_str());
+        }
+#endif
+    }
+
+    IslandHeader &header() const
+    {
+        return *reinterpret_cast<IslandHeader *>(base);
+    }
+
+    const IslandShape &shape() const
+    {
+        return header().shape;
+    }
+
+    IslandReport &report(int island) const
+    {
+        return reinterpret_cast<IslandReport *>(base + headerBytes())[island];
+    }
+
+    ChannelCursor &head(int from, int to) const
+    {
+        return *reinterpret_cast<ChannelCursor *>(channel(from, to));
+    }
+
+    ChannelCursor &tail(int from, int to) const
+    {
+        return *reinterpret_cast<ChannelCursor *>(channel(from, to) + cacheLineSize);
+    }
+
+    /**
+     * Migrant slots of a channel, the fitness followed by the position
+     */
+    double *slots(int from, int to) const
+    {
+        return reinterpret_cast<double *>(channel(from, to) + 2 * cacheLineSize);
+    }
+
+private:
+    static size_t roundUp(size_t bytes)
+    {
+        return (bytes + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+    }
+
+    static size_t headerBytes()
+    {
+        return roundUp(sizeof(IslandHeader));
+    }
+
+    static size_t reportBytes(const IslandShape &shape)
+    {
+        return roundUp(shape.islands * sizeof(IslandReport));
+    }
+
+    static size_t channelBytes(const IslandShape &shape)
+    {
+        return 2 * cacheLineSize + roundUp(shape.capacity() * (shape.dim + 1) * sizeof(double));
+    }
+
+    static size_t layoutBytes(const IslandShape &shape)
+    {
+        return headerBytes() + reportBytes(shape) + shape.islands * shape.islands * channelBytes(shape);
+    }
+
+    char *channel(int from, int to) const
+    {
+        const IslandShape &layout = shape();
+
+        return base + headerBytes() + reportBytes(layout) + (from * layout.islands + to) * channelBytes(layout);
+    }
+
+    void construct(const IslandShape &shape)
+    {
+        IslandHeader *created = new (base) IslandHeader{};
+        created->shape = shape;
+        created->globalBest.store(bit_cast<uint64_t>(numeric_limits<double>::max()));
+
+        for (int from = 0; from < shape.islands; ++from)
+        {
+            for (int to = 0; to < shape.islands; ++to)
+            {
+                new (&head(from, to)) ChannelCursor{};
+                new (&tail(from, to)) ChannelCursor{};
+            }
+        }
+    }
+
+    AlignedVector<double> heap;
+    char *base = nullptr;
+    size_t size = 0;
+    string name;
+    bool owner = false;
+};
+
+/**
+ * One island's view of the arena: the channels to the islands it sends to and receives from, and the global best
+ * Sending and receiving never wait, a full channel drops the migrant and an empty one yields nothing
+ */
+class IslandLink
+{
+public:
+    IslandLink(IslandArena &arena, int island) : arena(arena), island(island)
+    {
+        const IslandShape &shape = arena.shape();
+
+        for (int other = 0; other < shape.islands; ++other)
+        {
+            if (other == island)
+                continue;
+
+            if (shape.topology == MigrationTopology::Full || other == (island + 1) % shape.islands)
+                targets.push_back(other);
+
+            if (shape.topology == MigrationTopology::Full || other == (island + shape.islands - 1) % shape.islands)
+                sources.push_back(other);
+        }
+    }
+
+    int interval() const
+    {
+        return arena.shape().interval;
+    }
+
+    int migrants() const
+    {
+        return arena.shape().migrants;
+    }
+
+    /**
+     * Offer one firefly to every island this one sends to
+     */
+    void send(span<const double> position, double fitness)
+    {
+        const int capacity = arena.shape().capacity();
+        const size_t slotSize = position.size() + 1;
+
+        for (int to : targets)
+        {
+            const uint64_t head = arena.head(island, to).value.load(memory_order_relaxed);
+
+            if (head - arena.tail(island, to).value.load(memory_order_acquire) >= uint64_t(capacity))
+                continue;
+
+            double *slot = arena.slots(island, to) + (head % capacity) * slotSize;
+            slot[0] = fitness;
+            copy(position.begin(), position.end(), slot + 1);
+
+            // Publishes the slot to the receiver
+            arena.head(island, to).value.store(head + 1, memory_order_release);
+        }
+    }
+
+    /**
+     * Hand every waiting migrant to accept(position, fitness), returns how many there were
+     */
+    template <typename Accept>
+    int receive(Accept accept)
+    {
+        const int capacity = arena.shape().capacity();
+        const int dim = arena.shape().dim;
+        int received = 0;
+
+        for (int from : sources)
+        {
+            uint64_t tail = arena.tail(from, island).value.load(memory_order_relaxed);
+            const uint64_t head = arena.head(from, island).value.load(memory_order_acquire);
+
+            for (; tail < head; ++tail, ++received)
+            {
+                const double *slot = arena.slots(from, island) + (tail % capacity) * (dim + 1);
+                accept(span<const double>(slot + 1, dim), slot[0]);
+            }
+
+            // Hands the slots back to the sender
+            arena.tail(from, island).value.store(tail, memory_order_release);
+        }
+
+        return received;
+    }
+
+    /**
+     * Lower the global best to fitness if it is better
+     */
+    void offerBest(double fitness)
+    {
+        atomic<uint64_t> &best = arena.header().globalBest;
+        uint64_t current = best.load(memory_order_relaxed);
+
+        while (fitness < bit_cast<double>(current) && !best.compare_exchange_weak(current, bit_cast<uint64_t>(fitness), memory_order_relaxed))
+        {
+        }
+    }
+
+    double globalBest() const
+    {
+        return bit_cast<double>(arena.header().globalBest.load(memory_order_relaxed));
+    }
+
+private:
+    IslandArena &arena;
+    const int island;
+    vector<int> targets;
+    vector<int> sources;
+};
+
+#ifdef __linux__
+/**
+ * Start another copy of this program with the given arguments
+ */
+inline pid_t spawnSelf(const vector<string> &arguments)
+{
+    vector<char *> argv;
+
+    for (const string &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+
+    argv.push_back(nullptr);
+
+    pid_t pid;
+
+    if (posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv.data(), environ) != 0)
+        throw runtime_error("cannot start an island process");
+
+    return pid;
+}
+
+/**
+ * Wait for a process, true when it exited with status 0
+ */
+inline bool waitForProcess(pid_t pid)
+{
+    int status = 0;
+
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            return false;
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+#endif
+
+/**
+ * Master seed of one island, the island is mixed into the key of its streams so they are apart from those of
+ * every other island and of every plain run, whatever the run index
+ */
+inline uint64_t islandSeed(uint64_t seed, int island)
+{
+    return seed ^ mix64(uint64_t(island) + 1);
+}
+
+/**
+ * The part of an island's result the run merges with those of the other islands
+ */
+inline IslandReport islandReport(const FireflyResult &result)
+{
+    return {
+        .bestFitness = result.bestFitness,
+        .rngSeconds = result.rngSeconds,
+        .syncSeconds = result.syncSeconds,
+        .evaluations = result.evaluations,
+        .generations = result.generations,
+        .target = result.target,
+        .migrants = result.migrants,
+    };
+}
+
+/**
+ * Run this process as one island of another process's run, the settings are the same as that process's
+ * worker is the arena to join and the island index, placement the CPUs of the pinned thread slots
+ */
+inline int runIslandWorker(const string &worker, const vector<FunctionBenchmark> &functions, vector<int> &placement)
+{
+#ifdef __linux__
+    const vector<string> parts = splitList(worker);
+
+    if (parts.size() != 2)
+        throw runtime_error("island.worker needs arena,index");
+
+    IslandArena arena(parts[0], nullptr);
+    const IslandHeader &header = arena.header();
+    const int island = stoi(parts[1]);
+
+    objectiveSeed = header.objectiveSeed;
+
+    // Every island takes the next share of the pinned CPUs, as its thread team would in one process
+    if (!placement.empty())
+        rotate(placement.begin(), placement.begin() + (island * header.threads) % placement.size(), placement.end());
+
+    const FunctionBenchmark &func = findByName(functions, string(header.function), "function");
+    IslandLink link(arena, island);
+    FireflyOptions options = header.options;
+    options.island = &link;
+    options.seed = islandSeed(options.seed, island);
+
+    arena.report(island) = islandReport(fireflyAlgorithm(func, header.threads, options, header.run));
+
+    return 0;
+#else
+    throw runtime_error("island processes need Linux");
+#endif
+}
@@ -0,0 +1,503 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <limits>
+#include <omp.h>
+#include "functions.cpp"
+#include "helper_functions.cpp"
+#include "firefly.hpp"
+#include "population.cpp"
+#include "config.cpp"
+#include "timing.cpp"
+#include "affinity.cpp"
+
+using namespace std;
+
+/**
+ * Objective function microbenchmark
+ * Times every function in isolation, the libm reference and the scalar entry point one candidate at a time and the
+ * SIMD batch kernels over batches of candidates, across dimensions, and checks that the batch kernels agree with the
+ * reference. The scalar entry point and the batch kernels follow the math setting.
+ */
+
+/**
+ * One objective function, its libm reference, scalar and batch entry points, and the dimension it is fixed to (0 when it is not)
+ */
+struct Objective
+{
+    string name;
+    double (*reference)(span<const double>);
+    double (*scalar)(span<const double>);
+    void (*batch)(const double *x, size_t stride, int count, int dim, double *out);
+    double min_range;
+    double max_range;
+    int fixedDim;
+};
+
+#define OBJECTIVE(fixedDim, min_range, max_range, name) {#name, name, name, name##Batch, min_range, max_range, fixedDim}
+// Functions on the math layer, their reference is the libm instantiation
+#define MATH_OBJECTIVE(fixedDim, min_range, max_range, name) {#name, name##With<MathMode::Libm>, name, name##Batch, min_range, max_range, fixedDim}
+
+const vector<Objective> objectives = {
+    OBJECTIVE(0, -10, 10, sumSquares),
+    OBJECTIVE(0, -100, 100, step2),
+    OBJECTIVE(0, -1.28, 1.28, quartic),
+    OBJECTIVE(0, -4, 5, powell),
+    OBJECTIVE(0, -30, 30, rosenbrock),
+    OBJECTIVE(0, -10, 10, dixonPrice),
+    OBJECTIVE(0, -100, 100, schwefel1_2),
+    OBJECTIVE(0, -100, 100, schwefel2_20),
+    OBJECTIVE(0, -100, 100, schwefel2_21),
+    MATH_OBJECTIVE(0, -5.12, 5.12, rastrigin),
+    MATH_OBJECTIVE(0, -600, 600, griewank),
+    MATH_OBJECTIVE(0, -1, 1, csendes),
+    OBJECTIVE(4, -10, 10, colville),
+    MATH_OBJECTIVE(2, -100, 100, easom),
+    MATH_OBJECTIVE(0, 0, M_PI, michalewicz),
+    OBJECTIVE(4, 0, 10, shekel),
+    OBJECTIVE(0, 0, 10, schwefel2_4),
+    MATH_OBJECTIVE(0, -500, 500, schwefel),
+    MATH_OBJECTIVE(0, -100, 100, schaffer),
+    MATH_OBJECTIVE(0, -10, 10, alpine),
+    MATH_OBJECTIVE(0, -32, 32, ackley),
+    OBJECTIVE(0, -5.12, 5.12, sphere),
+    OBJECTIVE(0, -10, 10, schwefel2_22)};
+
+/**
+ * Parameters, set from the command line or a config file
+ */
+vector<Objective> selectedObjectives = objectives;
+vector<int> dimensions = {4, 16, 60, 256, 1024};
+vector<int> batchSizes = {1, 8, 64, 512};
+// Timed samples per measurement, and the minimum duration of one sample
+int sampleCount = 5;
+double sampleSeconds = 0.01;
+// Untimed time before every measurement
+double warmupSeconds = 0.02;
+// Maximum relative error against the libm reference, 0 picks the default of the math mode
+double tolerance = 0.0;
+// CPU the benchmark thread is bound to, -1 leaves it to the operating system
+int pinCpu = -1;
+uint64_t seed = 42;
+
+/**
+ * Table formatting, a narrower name column than the optimizer tables, numWidth is shared with them
+ */
+const int functionWidth = 24;
+
+/**
+ * Result of timing one function at one dimension and one batch size, 0 for the libm reference and -1 for the scalar entry point
+ */
+struct Measurement
+{
+    string name;
+    int dim;
+    int batch;
+    MathMode mode;
+    // Median of the samples
+    double nanosecondsPerEvaluation;
+    double evaluationsPerSecond;
+};
+
+/**
+ * Keeps the compiler from dropping evaluations whose results are never used
+ */
+volatile double sink;
+
+/**
+ * Candidates drawn uniformly from the search range, stored dimension-major with a padded stride as the batch kernels expect
+ */
+AlignedVector<double> randomCandidates(const Objective &objective, int dim, int count, size_t stride, uint64_t stream)
+{
+    AlignedVector<double> x(stride * dim, 0.0);
+    RandomStream random(seed, RandomPurpose::Initialization, uint32_t(stream), 0, 0);
+
+    for (int k = 0; k < dim; ++k)
+        for (int c = 0; c < count; ++c)
+            x[k * stride + c] = randomDouble(objective.min_range, objective.max_range, random, uint64_t(k) * count + c);
+
+    return x;
+}
+
+/**
+ * Time body, which performs evaluationsPerCall evaluations, after warming up
+ * Every sample repeats body until it lasts at least sampleSeconds, the median sample is reported
+ */
+template <typename Body>
+double timeEvaluations(Body body, int evaluationsPerCall)
+{
+    using Clock = chrono::steady_clock;
+
+    // Warmup, which also estimates how many calls fill one sample
+    long calls = 0;
+    const Clock::time_point warmupStart = Clock::now();
+
+    while (chrono::duration<double>(Clock::now() - warmupStart).count() < warmupSeconds)
+    {
+        body();
+        calls++;
+    }
+
+    const double secondsPerCall = warmupSeconds / max(calls, 1L);
+    const long callsPerSample = max(1L, long(sampleSeconds / secondsPerCall));
+
+    vector<double> samples(sampleCount);
+
+    for (double &sample : samples)
+    {
+        const Clock::time_point start = Clock::now();
+
+        for (long call = 0; call < callsPerSample; ++call)
+            body();
+
+        sample = chrono::duration<double>(Clock::now() - start).count() / (callsPerSample * evaluationsPerCall);
+    }
+
+    return median(samples) * 1e9;
+}
+
+/**
+ * Time a scalar implementation, the libm reference or the entry point, one contiguous candidate per call
+ */
+Measurement measureScalar(const Objective &objective, int dim, bool reference)
+{
+    double (*function)(span<const double>) = reference ? objective.reference : objective.scalar;
+
+    const int poolSize = 64;
+    const size_t stride = padToCacheLine(dim);
+    AlignedVector<double> pool(stride * poolSize);
+
+    // Transpose the dimension-major candidates into one contiguous row each
+    AlignedVector<double> candidates = randomCandidates(objective, dim, poolSize, padToCacheLine(poolSize), dim);
+
+    for (int c = 0; c < poolSize; ++c)
+        for (int k = 0; k < dim; ++k)
+            pool[c * stride + k] = candidates[k * padToCacheLine(poolSize) + c];
+
+    const double nanoseconds = timeEvaluations([&]()
+                                               {
+                                                   double sum = 0.0;
+
+                                                   for (int c = 0; c < poolSize; ++c)
+                                                       sum += function(span<const double>(&pool[c * stride], dim));
+
+                                                   sink = sum; },
+                                               poolSize);
+
+    return {objective.name, dim, reference ? 0 : -1, reference ? MathMode::Libm : mathMode, nanoseconds, 1e9 / nanoseconds};
+}
+
+/**
+ * Time the batch kernel on batches of batch candidates
+ */
+Measurement measureBatch(const Objective &objective, int dim, int batch)
+{
+    const size_t stride = padToCacheLine(batch);
+    AlignedVector<double> candidates = randomCandidates(objective, dim, batch, stride, dim);
+    AlignedVector<double> out(stride);
+
+    const double nanoseconds = timeEvaluations([&]()
+                                               {
+                                                   objective.batch(candidates.data(), stride, batch, dim, out.data());
+                                                   sink = out[0]; },
+                                               batch);
+
+    return {objective.name, dim, batch, mathMode, nanoseconds, 1e9 / nanoseconds};
+}
+
+/**
+ * Largest relative error of the batch kernel and the scalar entry point against the reference, over a batch whose size
+ * is not a multiple of the SIMD width, so the scalar tail of the kernel is checked too
+ */
+double referenceError(const Objective &objective, int dim)
+{
+    const int count = 8 * SimdDouble::width + SimdDouble::width / 2 + 1;
+    const size_t stride = padToCacheLine(count);
+    AlignedVector<double> candidates = randomCandidates(objective, dim, count, stride, 1000 + dim);
+    AlignedVector<double> out(count);
+    vector<double> row(dim);
+
+    objective.batch(candidates.data(), stride, count, dim, out.data());
+
+    double error = 0.0;
+
+    for (int c = 0; c < count; ++c)
+    {
+        for (int k = 0; k < dim; ++k)
+            row[k] = candidates[k * stride + c];
+
+        const double expected = objective.reference(row);
+        error = max(error, abs(out[c] - expected) / max(1.0, abs(expected)));
+        error = max(error, abs(objective.scalar(row) - expected) / max(1.0, abs(expected)));
+    }
+
+    return error;
+}
+
+/**
+ * Dimensions to measure a function at, its own one when it is fixed
+ */
+vector<int> dimensionsOf(const Objective &objective)
+{
+    if (objective.fixedDim > 0)
+        return {objective.fixedDim};
+
+    vector<int> dims;
+
+    // powell works on groups of four coordinates
+    for (int dim : dimensions)
+        dims.push_back(objective.name == "powell" ? max(4, dim / 4 * 4) : max(2, dim));
+
+    dims.erase(unique(dims.begin(), dims.end()), dims.end());
+
+    return dims;
+}
+
+void printUsage()
+{
+    cout << "Usage: microbench [--key value | --key=value]... [--config file]" << endl;
+    cout << endl;
+    cout << "  functions = a,b,...       functions to measure (default all)" << endl;
+    cout << "  dims = a,b,...            dimensions of the functions not fixed to one (default 4,16,60,256,1024)" << endl;
+    cout << "  batch = a,b,...           candidates per batch kernel call (default 1,8,64,512)" << endl;
+    cout << "  samples = N               timed samples per measurement, the median is reported (default " << sampleCount << ")" << endl;
+    cout << "  sample = seconds          minimum duration of one sample (default " << sampleSeconds << ")" << endl;
+    cout << "  warmup = seconds          untimed run before every measurement (default " << warmupSeconds << ")" << endl;
+    cout << "  math = libm|precise|fast  how the kernels evaluate sin, cos, exp and sqrt (default libm)" << endl;
+    cout << "  tolerance = x             largest relative error against libm (default 1e-9, 1e-5 with fast math)" << endl;
+    cout << "  pin = cpu                 CPU to run on (default none)" << endl;
+    cout << "  seed = N                  seed of the candidates and the quartic noise" << endl;
+}
+
+/**
+ * Apply the settings, returns false when only the usage was asked for
+ */
+bool configure(int argc, char *argv[])
+{
+    for (const Setting &setting : parseArguments(argc, argv))
+    {
+        const string &key = setting.key;
+
+        if (key == "help")
+        {
+            printUsage();
+            return false;
+        }
+        else if (key == "functions")
+        {
+            selectedObjectives.clear();
+
+            for (const string &name : splitList(setting.value))
+            {
+                auto objective = find_if(objectives.begin(), objectives.end(), [&](const Objective &objective)
+                                         { return objective.name == name; });
+
+                if (objective == objectives.end())
+                    throw runtime_error("unknown function " + name);
+
+                selectedObjectives.push_back(*objective);
+            }
+        }
+        else if (key == "dims")
+        {
+            dimensions = parseNumberList<int>(setting);
+        }
+        else if (key == "batch")
+        {
+            batchSizes = parseNumberList<int>(setting);
+        }
+        else if (key == "samples")
+        {
+            sampleCount = parseNumber<int>(setting);
+        }
+        else if (key == "sample")
+        {
+            sampleSeconds = parseNumber<double>(setting);
+        }
+        else if (key == "warmup")
+        {
+            warmupSeconds = parseNumber<double>(setting);
+        }
+        else if (key == "math")
+        {
+            mathMode = parseMathMode(setting.value);
+        }
+        else if (key == "tolerance")
+        {
+            tolerance = parseNumber<double>(setting);
+        }
+        else if (key == "pin")
+        {
+            pinCpu = parseNumber<int>(setting);
+        }
+        else if (key == "seed")
+        {
+            seed = parseNumber<uint64_t>(setting);
+        }
+        else
+        {
+            throw runtime_error("unknown setting " + key);
+        }
+    }
+
+    if (tolerance <= 0.0)
+        tolerance = mathMode == MathMode::Fast ? 1e-5 : 1e-9;
+
+    if (sampleCount < 1 || sampleSeconds <= 0.0 || warmupSeconds <= 0.0)
+        throw runtime_error("samples must be at least 1, sample and warmup longer than 0");
+
+    for (int value : dimensions)
+    {
+        if (value < 1)
+            throw runtime_error("dimensions must be at least 1");
+    }
+
+    for (int value : batchSizes)
+    {
+        if (value < 1)
+            throw runtime_error("batch sizes must be at least 1");
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (!configure(argc, argv))
+            return 0;
+    }
+    catch (const exception &error)
+    {
+        cerr << "Error: " << error.what() << endl;
+        cerr << "Run with --help to list the settings" << endl;
+        return 1;
+    }
+
+    objectiveSeed = seed;
+
+    if (pinCpu >= 0)
+    {
+        pinThread({pinCpu});
+        cout << "Pinned to CPU " << pinCpu << endl;
+    }
+
+    cout << "SIMD width " << SimdDouble::width << ", " << mathModeNames[int(mathMode)] << " math, ns per evaluation, median of " << sampleCount << " samples" << endl;
+    cout << endl;
+
+    printElement("Function", functionWidth);
+    printElement("Dim", 6);
+    printElement("Libm", numWidth);
+    printElement("Scalar", numWidth);
+
+    for (int batch : batchSizes)
+        printElement("Batch " + to_string(batch), numWidth);
+
+    // Reference time over the fastest batch size
+    printElement("Speedup", numWidth);
+    // Libm batch time over the math mode batch time, both at the fastest batch size
+    printElement("Math gain", numWidth);
+    printElement("Error vs libm", numWidth);
+    cout << endl;
+    cout << endl;
+
+    vector<Measurement> measurements;
+    int failures = 0;
+
+    for (const Objective &objective : selectedObjectives)
+    {
+        for (int dim : dimensionsOf(objective))
+        {
+            printElement(objective.name, functionWidth);
+            printElement(dim, 6);
+
+            Measurement reference = measureScalar(objective, dim, true);
+            measurements.push_back(reference);
+            printElementPrecise(reference.nanosecondsPerEvaluation, numWidth, 1);
+
+            Measurement scalar = measureScalar(objective, dim, false);
+            measurements.push_back(scalar);
+            printElementPrecise(scalar.nanosecondsPerEvaluation, numWidth, 1);
+
+            double fastest = numeric_limits<double>::infinity();
+            int fastestBatch = batchSizes[0];
+
+            for (int batch : batchSizes)
+            {
+                Measurement measurement = measureBatch(objective, dim, batch);
+                measurements.push_back(measurement);
+                printElementPrecise(measurement.nanosecondsPerEvaluation, numWidth, 1);
+
+                if (measurement.nanosecondsPerEvaluation < fastest)
+                {
+                    fastest = measurement.nanosecondsPerEvaluation;
+                    fastestBatch = batch;
+                }
+            }
+
+            std::ostringstream speedup;
+            speedup << std::fixed << std::setprecision(2) << reference.nanosecondsPerEvaluation / fastest << "x";
+            printElement(speedup.str(), numWidth);
+
+            // The same batch through libm, measured only when the mode differs
+            const MathMode selectedMode = mathMode;
+            double libmBatch = fastest;
+
+            if (selectedMode != MathMode::Libm)
+            {
+                mathMode = MathMode::Libm;
+                Measurement measurement = measureBatch(objective, dim, fastestBatch);
+                measurements.push_back(measurement);
+                libmBatch = measurement.nanosecondsPerEvaluation;
+                mathMode = selectedMode;
+            }
+
+            std::ostringstream gain;
+            gain << std::fixed << std::setprecision(2) << libmBatch / fastest << "x";
+            printElement(gain.str(), numWidth);
+
+            const double error = referenceError(objective, dim);
+            std::ostringstream check;
+            check << std::scientific << std::setprecision(1) << error << (error <= tolerance ? "" : " FAIL");
+            printElement(check.str(), numWidth);
+
+            if (!(error <= tolerance))
+                failures++;
+
+            cout << endl;
+        }
+    }
+
+    ofstream file("microbench.csv");
+
+    file << "Function,Dim,Batch,Math,ns per evaluation,ns per evaluation and dimension,Evaluations per second" << endl;
+
+    for (const Measurement &measurement : measurements)
+    {
+        const string batch = measurement.batch == 0 ? "reference" : measurement.batch < 0 ? "scalar" : to_string(measurement.batch);
+
+        file << measurement.name << "," << measurement.dim << "," << batch << "," << mathModeNames[int(measurement.mode)] << ","
+             << measurement.nanosecondsPerEvaluation << "," << measurement.nanosecondsPerEvaluation / measurement.dim << ","
+             << measurement.evaluationsPerSecond << endl;
+    }
+
+    file.close();
+
+    cout << endl;
+
+    if (failures > 0)
+    {
+        cout << failures << " functions differ from the reference by more than " << tolerance << endl;
+        return 1;
+    }
+
+    cout << "All functions match the reference within " << tolerance << endl;
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+#include "distance.cpp"
+#include "random.cpp"
+
+using namespace std;
+
+/**
+ * Random projections of the approximate nearest neighbour index
+ */
+const int projectionCount = 2;
+
+/**
+ * Sort order by key, ties broken by index so the order is unique
+ * A sorted order is repaired by insertion sort, which is linear when the keys barely moved since the last sort.
+ * When repairing costs more than a few shifts per element the rest falls back to a full sort.
+ */
+inline void sortByKey(int *order, const double *key, int count, bool sorted)
+{
+    auto before = [&](int a, int b)
+    { return key[a] < key[b] || (key[a] == key[b] && a < b); };
+
+    if (!sorted)
+    {
+        iota(order, order + count, 0);
+        sort(order, order + count, before);
+        return;
+    }
+
+    long budget = 8L * count;
+
+    for (int i = 1; i < count; ++i)
+    {
+        const int item = order[i];
+        int j = i;
+
+        for (; j > 0 && budget > 0 && before(item, order[j - 1]); --j, --budget)
+            order[j] = order[j - 1];
+
+        order[j] = item;
+
+        if (budget == 0)
+        {
+            sort(order, order + count, before);
+            return;
+        }
+    }
+}
+
+/**
+ * Bounded neighbour sets of a generation, the fireflies each firefly is compared with instead of the whole swarm
+ * Rows are flat, row i at i * k, and sorted by index so the moves read the population in address order.
+ * The brightest mode has one row shared by every firefly.
+ */
+class NeighbourLists
+{
+public:
+    NeighbourLists(Neighbourhood mode, int population, int neighbours, uint64_t seed, int run, int numThreads)
+        : mode(mode), population(population), k(clamp(neighbours, 1, population - 1)), seed(seed), run(run),
+          lists(mode == Neighbourhood::All ? 0 : mode == Neighbourhood::Brightest ? k : population * k),
+          counts(mode == Neighbourhood::All ? 0 : population),
+          order(mode == Neighbourhood::Brightest ? population : mode == Neighbourhood::Nearest ? projectionCount * population : 0),
+          keys(mode == Neighbourhood::Nearest ? projectionCount * population : 0),
+          rank(keys.size()),
+          candidates(mode == Neighbourhood::Nearest ? numThreads : 0)
+    {
+    }
+
+    /**
+     * Fireflies firefly i is compared with this generation
+     */
+    span<const int> of(int i) const
+    {
+        if (mode == Neighbourhood::Brightest)
+            return span<const int>(lists.data(), k);
+
+        return span<const int>(&lists[i * k], counts[i]);
+    }
+
+    /**
+     * Rebuild the lists from the current positions and fitness
+     * Called by every thread of the team, the work is shared out by orphaned omp constructs
+     */
+    template <PopulationLayout Layout, int Dim, typename Scalar>
+    void rebuild(const Population<Layout, Dim, Scalar> &positions, const vector<double> &fitness, int gen)
+    {
+        if (mode == Neighbourhood::Brightest)
+        {
+#pragma omp single
+            {
+                sortByKey(order.data(), fitness.data(), population, sorted[0]);
+                sorted[0] = true;
+
+                copy_n(order.begin(), k, lists.begin());
+                sort(lists.begin(), lists.end());
+            }
+        }
+        else if (mode == Neighbourhood::Sampled)
+        {
+#pragma omp for schedule(static)
+            for (int i = 0; i < population; ++i)
+                sample(i, gen);
+        }
+        else if (mode == Neighbourhood::Nearest)
+        {
+            const int dim = positions.dimension();
+
+#pragma omp single
+            if (directions.empty())
+                drawDirections(dim);
+
+#pragma omp for schedule(static)
+            for (int i = 0; i < population; ++i)
+            {
+                for (int p = 0; p < projectionCount; ++p)
+                {
+                    double key = 0.0;
+
+                    for (int d = 0; d < dim; ++d)
+                        key += directions[p * dim + d] * positions(i, d);
+
+                    keys[p * population + i] = key;
+                }
+            }
+
+#pragma omp for schedule(static)
+            for (int p = 0; p < projectionCount; ++p)
+            {
+                sortByKey(&order[p * population], &keys[p * population], population, sorted[p]);
+                sorted[p] = true;
+
+                for (int position = 0; position < population; ++position)
+                    rank[p * population + order[p * population + position]] = position;
+            }
+
+#pragma omp for schedule(dynamic, 16)
+            for (int i = 0; i < population; ++i)
+                nearest(i, positions);
+        }
+    }
+
+private:
+    /**
+     * k distinct fireflies other than i, drawn from the stream of (run, gen, i), fewer if the draws keep colliding
+     */
+    void sample(int i, int gen)
+    {
+        int *row = &lists[i * k];
+        int count = 0;
+
+        if (k == population - 1)
+        {
+            for (int j = 0; j < population; ++j)
+            {
+                if (j != i)
+                    row[count++] = j;
+            }
+        }
+        else
+        {
+            RandomStream stream(seed, RandomPurpose::Neighbours, run, gen, i);
+
+            for (int draw = 0; draw < 4 * k && count < k; ++draw)
+            {
+                int j = min(int(stream.uniform(draw) * (population - 1)), population - 2);
+                j += j >= i ? 1 : 0;
+
+                if (find(row, row + count, j) == row + count)
+                    row[count++] = j;
+            }
+
+            sort(row, row + count);
+        }
+
+        counts[i] = count;
+    }
+
+    /**
+     * Random directions of the projections, drawn once per run
+     */
+    void drawDirections(int dim)
+    {
+        directions.resize(projectionCount * dim);
+
+        for (int p = 0; p < projectionCount; ++p)
+        {
+            RandomStream stream(seed, RandomPurpose::Projection, run, 0, p);
+
+            for (int d = 0; d < dim; ++d)
+                directions[p * dim + d] = stream.uniform(d) - 0.5;
+        }
+    }
+
+    /**
+     * The k nearest of the fireflies within k places of i along any projection, by Euclidean distance
+     * Close fireflies project close together, so the windows hold most of the true nearest neighbours
+     */
+    template <PopulationLayout Layout, int Dim, typename Scalar>
+    void nearest(int i, const Population<Layout, Dim, Scalar> &positions)
+    {
+        vector<pair<double, int>> &candidate = candidates[omp_get_thread_num()];
+        candidate.clear();
+
+        for (int p = 0; p < projectionCount; ++p)
+        {
+            const int at = rank[p * population + i];
+
+            for (int position = max(at - k, 0); position <= min(at + k, population - 1); ++position)
+            {
+                if (position != at)
+                    candidate.push_back({0.0, order[p * population + position]});
+            }
+        }
+
+        sort(candidate.begin(), candidate.end(), [](const auto &a, const auto &b)
+             { return a.second < b.second; });
+        candidate.erase(unique(candidate.begin(), candidate.end(), [](const auto &a, const auto &b)
+                               { return a.second == b.second; }),
+                        candidate.end());
+
+        for (auto &[squaredDistance, j] : candidate)
+            squaredDistance = pairSquaredDistance(positions, i, positions, j, DistanceMetric::SquaredEuclidean);
+
+        const int count = min<int>(k, candidate.size());
+
+        if (count > 0)
+            nth_element(candidate.begin(), candidate.begin() + count - 1, candidate.end());
+
+        int *row = &lists[i * k];
+
+        for (int c = 0; c < count; ++c)
+            row[c] = candidate[c].second;
+
+        sort(row, row + count);
+        counts[i] = count;
+    }
+
+    const Neighbourhood mode;
+    const int population;
+    const int k;
+    const uint64_t seed;
+    const int run;
+
+    vector<int> lists;
+    vector<int> counts;
+
+    // Brightest: fireflies by fitness. Nearest: fireflies by key along every projection, and the place of each
+    vector<int> order;
+    bool sorted[projectionCount] = {};
+    vector<double> keys;
+    vector<int> rank;
+    vector<double> directions;
+
+    // Candidates of the firefly each thread is looking at
+    vector<vector<pair<double, int>>> candidates;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <omp.h>
+#include "population.cpp"
+#include "random.cpp"
+
+using namespace std;
+
+/**
+ * Per-thread buffer of pre-generated movement noise
+ * Before every move the thread refills the draws of that move in one vectorized pass, or those of a tile of
+ * pairs in tiled mode, so the movement update only reads noise from an aligned array, of the type the positions are
+ * stored in
+ * Float buffers draw from the float stream, four draws per Philox block instead of two
+ */
+template <typename Scalar = double>
+struct alignas(cacheLineSize) NoiseBuffer
+{
+    /**
+     * Fill draws first..first + count of stream, scaled to scale * (u - 0.5)
+     */
+    void refill(const RandomStream &stream, size_t count, double scale, size_t first = 0)
+    {
+        double start = omp_get_wtime();
+
+        if (values.size() < count)
+            values.resize(count);
+
+        fillCenteredUniform(stream, count, scale, values.data(), first);
+
+        seconds += omp_get_wtime() - start;
+    }
+
+    AlignedVector<Scalar> values;
+
+    // Time spent generating noise, reported separately from the movement loop
+    double seconds = 0.0;
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Cache line size used for aligning and padding the population storage
+ */
+const size_t cacheLineSize = 64;
+const size_t doublesPerCacheLine = cacheLineSize / sizeof(double);
+
+/**
+ * Allocator handing out cache-line (and therefore SIMD register) aligned storage
+ */
+template <typename T, size_t Alignment = cacheLineSize>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &)
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(::operator new(n * sizeof(T), align_val_t(Alignment)));
+    }
+
+    void deallocate(T *p, size_t)
+    {
+        ::operator delete(p, align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const
+    {
+        return true;
+    }
+};
+
+template <typename T>
+using AlignedVector = vector<T, AlignedAllocator<T>>;
+
+/**
+ * Aligned allocator that leaves new elements uninitialized instead of zeroing them,
+ * so a page is first touched, and placed on its NUMA node, by the thread that first writes it
+ */
+template <typename T, size_t Alignment = cacheLineSize>
+struct FirstTouchAllocator : AlignedAllocator<T, Alignment>
+{
+    template <typename U>
+    struct rebind
+    {
+        using other = FirstTouchAllocator<U, Alignment>;
+    };
+
+    FirstTouchAllocator() = default;
+
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U, Alignment> &)
+    {
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args)
+    {
+        if constexpr (sizeof...(Args) == 0)
+            ::new (static_cast<void *>(p)) U;
+        else
+            ::new (static_cast<void *>(p)) U(forward<Args>(args)...);
+    }
+};
+
+template <typename T>
+using FirstTouchVector = vector<T, FirstTouchAllocator<T>>;
+
+/**
+ * Round a number of doubles, or of another element type, up to a whole number of cache lines
+ */
+template <typename T = double>
+constexpr size_t padToCacheLine(size_t count)
+{
+    constexpr size_t perLine = cacheLineSize / sizeof(T);
+
+    return (count + perLine - 1) / perLine * perLine;
+}
+
+/**
+ * Flat population matrix
+ * AoS stores each firefly contiguously (row-major), SoA stores each dimension contiguously (dimension-major)
+ * The leading dimension is padded so every row starts on a cache line
+ * A non-zero Dim fixes the dimension at compile time, so AoS indexing uses a constant stride
+ * Scalar is the type the coordinates are stored in, float halves the memory a generation streams through
+ */
+template <PopulationLayout Layout, int Dim = 0, typename Scalar = double>
+class Population
+{
+public:
+    Population(int count, int dim)
+        : count(count), dim(Dim > 0 ? Dim : dim), stride(padToCacheLine<Scalar>(Layout == PopulationLayout::AoS ? this->dim : count)),
+          values(stride * (Layout == PopulationLayout::AoS ? count : this->dim))
+    {
+    }
+
+    Scalar &operator()(int i, int k)
+    {
+        if constexpr (Layout == PopulationLayout::AoS)
+            return values[i * rowStride() + k];
+        else
+            return values[k * stride + i];
+    }
+
+    Scalar operator()(int i, int k) const
+    {
+        if constexpr (Layout == PopulationLayout::AoS)
+            return values[i * rowStride() + k];
+        else
+            return values[k * stride + i];
+    }
+
+    int dimension() const
+    {
+        return Dim > 0 ? Dim : dim;
+    }
+
+    /**
+     * Contiguous view of firefly i, gathered into scratch when the layout does not store it contiguously
+     */
+    span<const Scalar> position(int i, Scalar *scratch) const
+    {
+        if constexpr (Layout == PopulationLayout::AoS)
+        {
+            return span<const Scalar>(&values[i * rowStride()], dimension());
+        }
+        else
+        {
+            for (int k = 0; k < dimension(); ++k)
+                scratch[k] = values[k * stride + i];
+
+            return span<const Scalar>(scratch, dimension());
+        }
+    }
+
+    /**
+     * Firefly i as T, converted into scratch when T is not the type it is stored in
+     */
+    template <typename T>
+    span<const T> positionAs(int i, T *scratch) const
+    {
+        if constexpr (is_same_v<T, Scalar>)
+        {
+            return position(i, scratch);
+        }
+        else
+        {
+            for (int k = 0; k < dimension(); ++k)
+                scratch[k] = (*this)(i, k);
+
+            return span<const T>(scratch, dimension());
+        }
+    }
+
+    int count;
+    int dim;
+    size_t stride;
+    // Written first by the threads initializing the fireflies
+    FirstTouchVector<Scalar> values;
+
+private:
+    size_t rowStride() const
+    {
+        if constexpr (Dim > 0)
+            return padToCacheLine<Scalar>(Dim);
+        else
+            return stride;
+    }
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "population.cpp"
+
+using namespace std;
+
+// The phase timers read the cycle counter a few times per pair, which slows cheap objectives noticeably,
+// so they are only compiled in by a profiling build with -DFIREFLY_PHASE_TIMERS=1
+#ifndef FIREFLY_PHASE_TIMERS
+#define FIREFLY_PHASE_TIMERS 0
+#endif
+
+constexpr bool phaseTimersEnabled = FIREFLY_PHASE_TIMERS;
+
+const array<string, phaseCount> phaseNames = {"Init", "Distance", "Movement", "Evaluation", "Sync"};
+
+/**
+ * Cheapest monotonic tick the target has, the time stamp counter on x86
+ */
+inline uint64_t phaseTicks()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Taken at startup, ticks are converted to seconds against the steady clock over the life of the program
+const uint64_t phaseTickOrigin = phaseTicks();
+const chrono::steady_clock::time_point phaseTimeOrigin = chrono::steady_clock::now();
+
+inline double secondsPerPhaseTick()
+{
+    const uint64_t ticks = phaseTicks() - phaseTickOrigin;
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - phaseTimeOrigin).count();
+
+    return ticks > 0 ? seconds / ticks : 0.0;
+}
+
+/**
+ * Per-thread ticks spent in every phase, padded so threads never share a cache line
+ */
+struct alignas(cacheLineSize) ThreadPhases
+{
+    array<uint64_t, phaseCount> ticks{};
+};
+
+/**
+ * Charges the time between consecutive marks of one thread to the phase named at each mark
+ * With FIREFLY_PHASE_TIMERS=0 every call compiles to nothing
+ */
+class PhaseClock
+{
+public:
+    explicit PhaseClock(ThreadPhases &phases) : phases(phases)
+    {
+        restart();
+    }
+
+    /**
+     * Charge the time since the previous mark to phase
+     */
+    void mark(Phase phase)
+    {
+        if constexpr (phaseTimersEnabled)
+        {
+            const uint64_t now = phaseTicks();
+            phases.ticks[int(phase)] += now - last;
+            last = now;
+        }
+    }
+
+    /**
+     * Drop the time since the previous mark, it was charged elsewhere
+     */
+    void restart()
+    {
+        if constexpr (phaseTimersEnabled)
+            last = phaseTicks();
+    }
+
+private:
+    ThreadPhases &phases;
+    uint64_t last = 0;
+};
+
+/**
+ * Seconds per phase of every thread
+ */
+inline vector<PhaseTimes> phaseSeconds(const vector<ThreadPhases> &threads)
+{
+    if (!phaseTimersEnabled)
+        return {};
+
+    const double scale = secondsPerPhaseTick();
+    vector<PhaseTimes> times(threads.size());
+
+    for (size_t thread = 0; thread < threads.size(); ++thread)
+    {
+        for (int phase = 0; phase < phaseCount; ++phase)
+            times[thread][phase] = threads[thread].ticks[phase] * scale;
+    }
+
+    return times;
+}
+
+/**
+ * Cycles, instructions, cache misses and branch misses of the process, user space only
+ * The counters are inherited by every thread started after open(), so it has to run before the first
+ * parallel region. Without perf_event_open, or when the kernel forbids it, the counters stay invalid.
+ */
+class PerfCounters
+{
+public:
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+                close(fd);
+        }
+#endif
+    }
+
+    /**
+     * Start counting, returns false when the counters are unavailable
+     */
+    bool open()
+    {
+#ifdef __linux__
+        const array<pair<uint32_t, uint64_t>, 4> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // With more events than hardware counters the kernel multiplexes them, read() scales by these times
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+            if (fds[i] < 0)
+                return false;
+        }
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Events counted since open(), by all threads of the process
+     */
+    HardwareCounters read() const
+    {
+        HardwareCounters counters;
+        array<double, 4> values{};
+
+#ifdef __linux__
+        for (size_t i = 0; i < fds.size(); ++i)
+        {
+            uint64_t data[3];
+
+            if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != sizeof(data))
+                return counters;
+
+            values[i] = data[2] > 0 ? data[0] * ((double)data[1] / data[2]) : 0.0;
+        }
+
+        counters = {.valid = true, .cycles = values[0], .instructions = values[1], .cacheMisses = values[2], .branchMisses = values[3]};
+#endif
+
+        return counters;
+    }
+
+private:
+    array<int, 4> fds = {-1, -1, -1, -1};
+};
+
+/**
+ * Events between two reads of the counters, divided over runs
+ */
+inline HardwareCounters countersBetween(const HardwareCounters &start, const HardwareCounters &end, int runs)
+{
+    if (!start.valid || !end.valid)
+        return {};
+
+    return {
+        .valid = true,
+        .cycles = (end.cycles - start.cycles) / runs,
+        .instructions = (end.instructions - start.instructions) / runs,
+        .cacheMisses = (end.cacheMisses - start.cacheMisses) / runs,
+        .branchMisses = (end.branchMisses - start.branchMisses) / runs,
+    };
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+ * Every block of four 32-bit words is a pure function of a 128-bit counter and a 64-bit key,
+ * so any draw can be computed directly from its indices without carrying generator state around
+ */
+inline array<uint32_t, 4> philox4x32(array<uint32_t, 4> counter, array<uint32_t, 2> key)
+{
+    for (int round = 0; round < 10; ++round)
+    {
+        const uint64_t product0 = uint64_t(0xD2511F53) * counter[0];
+        const uint64_t product1 = uint64_t(0xCD9E8D57) * counter[2];
+
+        counter = {
+            uint32_t(product1 >> 32) ^ counter[1] ^ key[0],
+            uint32_t(product1),
+            uint32_t(product0 >> 32) ^ counter[3] ^ key[1],
+            uint32_t(product0)};
+
+        key[0] += 0x9E3779B9;
+        key[1] += 0xBB67AE85;
+    }
+
+    return counter;
+}
+
+/**
+ * Convert 64 random bits to a double uniformly distributed in [0, 1)
+ */
+inline double bitsToUniform(uint64_t bits)
+{
+    return (bits >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Convert 32 random bits to a float uniformly distributed in [0, 1)
+ */
+inline float bitsToUniformFloat(uint32_t bits)
+{
+    return (bits >> 8) * 0x1.0p-24f;
+}
+
+/**
+ * What a stream is used for, mixed into the key so streams with equal indices never overlap
+ */
+enum class RandomPurpose : uint32_t
+{
+    Initialization,
+    Movement,
+    Objective,
+    // Neighbour sampling and the projections of the nearest neighbour index
+    Neighbours,
+    Projection
+};
+
+/**
+ * Stream of uniform doubles keyed by the master seed and (run, generation, firefly)
+ * Draw number index of the stream is always the same value, whichever thread asks for it and when
+ */
+struct RandomStream
+{
+    RandomStream() = default;
+
+    RandomStream(uint64_t seed, RandomPurpose purpose, uint32_t run, uint32_t generation, uint32_t firefly)
+        : key{uint32_t(seed) ^ (uint32_t(purpose) * 0x9E3779B9u), uint32_t(seed >> 32)}, run(run), generation(generation), firefly(firefly)
+    {
+    }
+
+    double uniform(uint64_t index) const
+    {
+        // One Philox block holds two doubles
+        array<uint32_t, 4> block = philox4x32({run, generation, firefly, uint32_t(index >> 1)}, key);
+        const int half = (index & 1) * 2;
+
+        return bitsToUniform(uint64_t(block[half]) << 32 | block[half + 1]);
+    }
+
+    /**
+     * Draw index of the float stream, which shares the Philox blocks of the double stream but holds four draws per block
+     */
+    float uniformFloat(uint64_t index) const
+    {
+        array<uint32_t, 4> block = philox4x32({run, generation, firefly, uint32_t(index >> 2)}, key);
+
+        return bitsToUniformFloat(block[index & 3]);
+    }
+
+    array<uint32_t, 2> key;
+    uint32_t run;
+    uint32_t generation;
+    uint32_t firefly;
+};
+
+/**
+ * Master seed of the noise inside objective functions (quartic)
+ */
+uint64_t objectiveSeed = random_device{}();
+
+/**
+ * SplitMix64 finalizer, used to hash positions into stream indices
+ */
+inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Noise stream of an objective function evaluated at a point, keyed by a hash of the point itself
+ * The noise is then a pure function of the evaluated position, so it does not depend on which thread
+ * evaluates it, in which order, or whether it is evaluated alone or inside a batch
+ */
+template <typename T>
+inline RandomStream objectiveNoise(const T *x, size_t stride, int dim)
+{
+    uint64_t hash = 0;
+
+    for (int k = 0; k < dim; ++k)
+    {
+        // Hashed as a double, so a point has the same noise whatever precision it is evaluated in
+        const double value = x[k * stride];
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        hash = mix64(hash ^ bits);
+    }
+
+    return RandomStream(objectiveSeed, RandomPurpose::Objective, uint32_t(hash), uint32_t(hash >> 32), 0);
+}
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+
+#if defined(__AVX512F__)
+using PhiloxLanes = __m512i;
+const int philoxLaneCount = 8;
+inline PhiloxLanes philoxSet(uint64_t x) { return _mm512_set1_epi64(x); }
+inline PhiloxLanes philoxMul(PhiloxLanes a, PhiloxLanes b) { return _mm512_mul_epu32(a, b); }
+inline PhiloxLanes philoxHigh(PhiloxLanes a) { return _mm512_srli_epi64(a, 32); }
+inline PhiloxLanes philoxLow(PhiloxLanes a) { return _mm512_and_si512(a, _mm512_set1_epi64(0xFFFFFFFF)); }
+inline PhiloxLanes philoxXor(PhiloxLanes a, PhiloxLanes b) { return _mm512_xor_si512(a, b); }
+inline PhiloxLanes philoxIota(uint64_t first) { return _mm512_add_epi64(_mm512_set1_epi64(first), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0)); }
+#else
+using PhiloxLanes = __m256i;
+const int philoxLaneCount = 4;
+inline PhiloxLanes philoxSet(uint64_t x) { return _mm256_set1_epi64x(x); }
+inline PhiloxLanes philoxMul(PhiloxLanes a, PhiloxLanes b) { return _mm256_mul_epu32(a, b); }
+inline PhiloxLanes philoxHigh(PhiloxLanes a) { return _mm256_srli_epi64(a, 32); }
+inline PhiloxLanes philoxLow(PhiloxLanes a) { return _mm256_and_si256(a, _mm256_set1_epi64x(0xFFFFFFFF)); }
+inline PhiloxLanes philoxXor(PhiloxLanes a, PhiloxLanes b) { return _mm256_xor_si256(a, b); }
+inline PhiloxLanes philoxIota(uint64_t first) { return _mm256_add_epi64(_mm256_set1_epi64x(first), _mm256_set_epi64x(3, 2, 1, 0)); }
+#endif
+
+/**
+ * Philox4x32-10 on consecutive blocks, one block per 64-bit lane with the 32-bit words in the low halves
+ */
+inline void philoxLanes(const RandomStream &stream, uint64_t firstBlock, uint32_t (&words)[4][philoxLaneCount])
+{
+    PhiloxLanes c0 = philoxSet(stream.run);
+    PhiloxLanes c1 = philoxSet(stream.generation);
+    PhiloxLanes c2 = philoxSet(stream.firefly);
+    PhiloxLanes c3 = philoxLow(philoxIota(firstBlock));
+    uint32_t key0 = stream.key[0];
+    uint32_t key1 = stream.key[1];
+
+    for (int round = 0; round < 10; ++round)
+    {
+        const PhiloxLanes product0 = philoxMul(philoxSet(0xD2511F53), c0);
+        const PhiloxLanes product1 = philoxMul(philoxSet(0xCD9E8D57), c2);
+
+        c0 = philoxXor(philoxXor(philoxHigh(product1), c1), philoxSet(key0));
+        c1 = philoxLow(product1);
+        c2 = philoxXor(philoxXor(philoxHigh(product0), c3), philoxSet(key1));
+        c3 = philoxLow(product0);
+
+        key0 += 0x9E3779B9;
+        key1 += 0xBB67AE85;
+    }
+
+    alignas(64) uint64_t lanes[4][philoxLaneCount];
+    memcpy(lanes[0], &c0, sizeof(c0));
+    memcpy(lanes[1], &c1, sizeof(c1));
+    memcpy(lanes[2], &c2, sizeof(c2));
+    memcpy(lanes[3], &c3, sizeof(c3));
+
+    for (int w = 0; w < 4; ++w)
+        for (int l = 0; l < philoxLaneCount; ++l)
+            words[w][l] = uint32_t(lanes[w][l]);
+}
+
+#else
+
+const int philoxLaneCount = 1;
+
+inline void philoxLanes(const RandomStream &stream, uint64_t firstBlock, uint32_t (&words)[4][philoxLaneCount])
+{
+    array<uint32_t, 4> block = philox4x32({stream.run, stream.generation, stream.firefly, uint32_t(firstBlock)}, stream.key);
+
+    for (int w = 0; w < 4; ++w)
+        words[w][0] = block[w];
+}
+
+#endif
+
+/**
+ * Fill out[0..count) with scale * (uniform(first + index) - 0.5) for draws first..first + count of a stream
+ * Consecutive Philox blocks are computed side by side in vector registers,
+ * and every value is bit-identical to scale * (stream.uniform(first + index) - 0.5)
+ */
+inline void fillCenteredUniform(const RandomStream &stream, size_t count, double scale, double *out, size_t first = 0)
+{
+    const size_t end = first + count;
+    const size_t endBlock = (end + 1) / 2;
+
+    for (size_t base = first / 2; base < endBlock; base += philoxLaneCount)
+    {
+        uint32_t words[4][philoxLaneCount];
+        philoxLanes(stream, base, words);
+
+        alignas(64) double values[2 * philoxLaneCount];
+
+        for (int l = 0; l < philoxLaneCount; ++l)
+        {
+            values[2 * l] = scale * (bitsToUniform(uint64_t(words[0][l]) << 32 | words[1][l]) - 0.5);
+            values[2 * l + 1] = scale * (bitsToUniform(uint64_t(words[2][l]) << 32 | words[3][l]) - 0.5);
+        }
+
+        // Draws of this group of blocks that fall inside first..end
+        const size_t groupFirst = max(2 * base, first);
+        const size_t groupEnd = min(2 * (base + philoxLaneCount), end);
+
+        for (size_t draw = groupFirst; draw < groupEnd; ++draw)
+            out[draw - first] = values[draw - 2 * base];
+    }
+}
+
+/**
+ * Float counterpart, bit-identical to float(scale) * (stream.uniformFloat(first + index) - 0.5f)
+ * A block holds four float draws, so it needs half the Philox blocks of the double fill
+ */
+inline void fillCenteredUniform(const RandomStream &stream, size_t count, double scale, float *out, size_t first = 0)
+{
+    const size_t end = first + count;
+    const size_t endBlock = (end + 3) / 4;
+
+    for (size_t base = first / 4; base < endBlock; base += philoxLaneCount)
+    {
+        uint32_t words[4][philoxLaneCount];
+        philoxLanes(stream, base, words);
+
+        alignas(64) float values[4 * philoxLaneCount];
+
+        for (int l = 0; l < philoxLaneCount; ++l)
+            for (int w = 0; w < 4; ++w)
+                values[4 * l + w] = float(scale) * (bitsToUniformFloat(words[w][l]) - 0.5f);
+
+        const size_t groupFirst = max(4 * base, first);
+        const size_t groupEnd = min(4 * (base + philoxLaneCount), end);
+
+        for (size_t draw = groupFirst; draw < groupEnd; ++draw)
+            out[draw - first] = values[draw - 4 * base];
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * What grows with the thread count in a weak scaling run
+ */
+enum class WeakGrowth
+{
+    Population,
+    Dimension,
+    // Population and dimension share the growth
+    Both
+};
+
+const string weakGrowthNames[] = {"population", "dimension", "both"};
+
+/**
+ * Problem size of one weak scaling run
+ */
+struct WeakSize
+{
+    int population;
+    int dim;
+    // Work relative to the base size, the pairs of fireflies times the dimension
+    double work;
+};
+
+/**
+ * Serial fraction of a scaling model fitted to measured speedups, and how much of their variance the model explains
+ */
+struct ScalingFit
+{
+    double serialFraction = NAN;
+    double rSquared = NAN;
+};
+
+/**
+ * False for NaN and infinity, the values the scaling metrics take where they are undefined
+ * Checks the exponent bits, -ffast-math lets the compiler assume isnan and isfinite never fire
+ */
+inline bool isFiniteValue(double value)
+{
+    return (bit_cast<uint64_t>(value) & 0x7ff0000000000000ull) != 0x7ff0000000000000ull;
+}
+
+/**
+ * Size of a weak scaling run with factor times the threads of the base run
+ * A generation moves every firefly towards the brighter ones, so its work grows with population^2 * dim: the
+ * population grows with the square root of the factor, the dimension linearly, or both with a share each.
+ * Functions fixed to one dimension grow their population instead.
+ */
+inline WeakSize weakSize(int population, int dim, double factor, WeakGrowth grow, bool fixedDimension)
+{
+    if (fixedDimension)
+        grow = WeakGrowth::Population;
+
+    WeakSize size{population, dim, 1.0};
+
+    if (grow == WeakGrowth::Population)
+        size.population = lround(population * sqrt(factor));
+    else if (grow == WeakGrowth::Dimension)
+        size.dim = lround(dim * factor);
+    else
+    {
+        size.population = lround(population * pow(factor, 0.25));
+        size.dim = lround(dim * sqrt(factor));
+    }
+
+    size.population = max(size.population, 2);
+    size.dim = max(size.dim, 1);
+
+    size.work = (double)size.population * size.population * size.dim / ((double)population * population * dim);
+
+    return size;
+}
+
+/**
+ * Karp-Flatt metric, the serial fraction implied by a speedup on p times the threads of the base run
+ * A fraction that grows with p points at parallel overhead rather than at serial code
+ */
+inline double karpFlatt(double speedup, double p)
+{
+    if (p <= 1.0)
+        return NAN;
+
+    return (1.0 / speedup - 1.0 / p) / (1.0 - 1.0 / p);
+}
+
+/**
+ * Share of the variance of the measured speedups the predicted ones explain
+ */
+inline double rSquared(const vector<double> &measured, const vector<double> &predicted)
+{
+    if (measured.size() < 2)
+        return NAN;
+
+    double mean = 0.0;
+
+    for (double value : measured)
+        mean += value / measured.size();
+
+    double residual = 0.0;
+    double total = 0.0;
+
+    for (size_t i = 0; i < measured.size(); ++i)
+    {
+        residual += (measured[i] - predicted[i]) * (measured[i] - predicted[i]);
+        total += (measured[i] - mean) * (measured[i] - mean);
+    }
+
+    return total > 0.0 ? 1.0 - residual / total : NAN;
+}
+
+/**
+ * Amdahl's law S(p) = 1 / (f + (1 - f) / p), least squares in the linear form 1/S - 1/p = f (1 - 1/p)
+ */
+inline ScalingFit fitAmdahl(const vector<double> &p, const vector<double> &speedup)
+{
+    double xy = 0.0;
+    double xx = 0.0;
+
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        const double x = 1.0 - 1.0 / p[i];
+        xy += x * (1.0 / speedup[i] - 1.0 / p[i]);
+        xx += x * x;
+    }
+
+    if (xx == 0.0)
+        return {};
+
+    const double f = clamp(xy / xx, 0.0, 1.0);
+    vector<double> predicted;
+
+    for (double threads : p)
+        predicted.push_back(1.0 / (f + (1.0 - f) / threads));
+
+    return {f, rSquared(speedup, predicted)};
+}
+
+/**
+ * Gustafson's law for scaled speedups S(p) = p - a (p - 1), least squares on p - S = a (p - 1)
+ */
+inline ScalingFit fitGustafson(const vector<double> &p, const vector<double> &speedup)
+{
+    double xy = 0.0;
+    double xx = 0.0;
+
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        const double x = p[i] - 1.0;
+        xy += x * (p[i] - speedup[i]);
+        xx += x * x;
+    }
+
+    if (xx == 0.0)
+        return {};
+
+    const double a = clamp(xy / xx, 0.0, 1.0);
+    vector<double> predicted;
+
+    for (double threads : p)
+        predicted.push_back(threads - a * (threads - 1.0));
+
+    return {a, rSquared(speedup, predicted)};
+}
+
+/**
+ * Largest thread count up to which the efficiency stays at or above threshold, 0 when even the first falls short
+ */
+inline int scalingLimit(const vector<int> &threads, const vector<double> &efficiency, double threshold)
+{
+    int limit = 0;
+
+    for (size_t i = 0; i < threads.size() && efficiency[i] >= threshold; ++i)
+        limit = threads[i];
+
+    return limit;
+}
+
+inline WeakGrowth parseWeakGrowth(const string &name)
+{
+    for (int grow = 0; grow < 3; ++grow)
+    {
+        if (weakGrowthNames[grow] == name)
+            return WeakGrowth(grow);
+    }
+
+    throw runtime_error("unknown growth " + name + ", expected population, dimension or both");
+}
+
+/**
+ * Strong and weak scaling of one function and variant, every column relative to the first thread count
+ */
+struct ScalingStudy
+{
+    // Threads of every column over the threads of the first
+    vector<double> p;
+    vector<double> strongSpeedup;
+    vector<double> strongEfficiency;
+    vector<double> karpFlatt;
+    // Scaled speedup, the work of the grown problem over the time it took, relative to the first column
+    vector<double> weakSpeedup;
+    vector<double> weakEfficiency;
+    ScalingFit amdahl;
+    ScalingFit gustafson;
+    // Largest thread count that keeps the efficiency at the threshold
+    int strongLimit = 0;
+    int weakLimit = 0;
+};
+
+inline ScalingStudy studyScaling(const vector<int> &threads, const vector<double> &strongSeconds, const vector<double> &weakSeconds, const vector<WeakSize> &sizes, double threshold)
+{
+    ScalingStudy study;
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        const double p = (double)threads[i] / threads[0];
+        const double speedup = strongSeconds[0] / strongSeconds[i];
+        const double scaledSpeedup = sizes[i].work * weakSeconds[0] / weakSeconds[i];
+
+        study.p.push_back(p);
+        study.strongSpeedup.push_back(speedup);
+        study.strongEfficiency.push_back(speedup / p);
+        study.karpFlatt.push_back(karpFlatt(speedup, p));
+        study.weakSpeedup.push_back(scaledSpeedup);
+        study.weakEfficiency.push_back(scaledSpeedup / p);
+    }
+
+    study.amdahl = fitAmdahl(study.p, study.strongSpeedup);
+    study.gustafson = fitGustafson(study.p, study.weakSpeedup);
+    study.strongLimit = scalingLimit(threads, study.strongEfficiency, threshold);
+    study.weakLimit = scalingLimit(threads, study.weakEfficiency, threshold);
+
+    return study;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <omp.h>
+#include "population.cpp"
+#include "barrier.cpp"
+
+using namespace std;
+
+/**
+ * Tile deque of one thread, the owner pops from the back and thieves take from the front
+ * Deques hold a few dozen tiles per generation, so a spin lock per deque is cheaper than a lock-free protocol
+ */
+struct alignas(cacheLineSize) TileDeque
+{
+    void clear()
+    {
+        tiles.clear();
+        head = 0;
+    }
+
+    void push(int tile)
+    {
+        lock();
+        tiles.push_back(tile);
+        unlock();
+    }
+
+    bool popBack(int &tile)
+    {
+        lock();
+        bool found = tiles.size() > head;
+
+        if (found)
+        {
+            tile = tiles.back();
+            tiles.pop_back();
+        }
+
+        unlock();
+        return found;
+    }
+
+    bool popFront(int &tile)
+    {
+        lock();
+        bool found = tiles.size() > head;
+
+        if (found)
+            tile = tiles[head++];
+
+        unlock();
+        return found;
+    }
+
+private:
+    void lock()
+    {
+        while (busy.test_and_set(memory_order_acquire))
+            cpuRelax();
+    }
+
+    void unlock()
+    {
+        busy.clear(memory_order_release);
+    }
+
+    atomic_flag busy = ATOMIC_FLAG_INIT;
+    vector<int> tiles;
+    size_t head = 0;
+};
+
+/**
+ * Scheduler statistics of one thread, padded so threads never share a cache line
+ */
+struct alignas(cacheLineSize) ThreadSchedulerStats
+{
+    SchedulerStats stats;
+};
+
+/**
+ * Work-stealing scheduler for the tiles of one generation
+ * Tiles are dealt round-robin to the per-thread deques, a thread whose deque runs dry steals
+ * from the front of the others until every tile of the generation has been executed
+ */
+class WorkStealingScheduler
+{
+public:
+    WorkStealingScheduler(int threads) : deques(threads), threadStats(threads)
+    {
+    }
+
+    /**
+     * Start a generation of count tiles for a team of teamSize threads, called by one thread before deal
+     */
+    void begin(int count, int newTeamSize)
+    {
+        tileCount = count;
+        teamSize = newTeamSize;
+        remaining.store(count, memory_order_relaxed);
+    }
+
+    /**
+     * Fill the deque of thread with its share of the tiles, every thread calls this for itself
+     */
+    void deal(int thread)
+    {
+        deques[thread].clear();
+
+        for (int tile = thread; tile < tileCount; tile += teamSize)
+            deques[thread].push(tile);
+    }
+
+    /**
+     * Execute tiles on thread until none are left anywhere
+     */
+    template <typename Execute>
+    void run(int thread, Execute &&execute)
+    {
+        SchedulerStats &stats = threadStats[thread].stats;
+        int tile;
+
+        while (true)
+        {
+            if (!deques[thread].popBack(tile))
+            {
+                double idleStart = omp_get_wtime();
+                bool stolen = false;
+
+                while (!stolen && remaining.load(memory_order_acquire) > 0)
+                {
+                    stolen = steal(thread, tile);
+
+                    if (!stolen)
+                        cpuRelax();
+                }
+
+                stats.idleSeconds += omp_get_wtime() - idleStart;
+
+                if (!stolen)
+                    return;
+
+                stats.steals++;
+            }
+
+            execute(tile);
+            stats.tiles++;
+            remaining.fetch_sub(1, memory_order_release);
+        }
+    }
+
+    vector<SchedulerStats> stats() const
+    {
+        vector<SchedulerStats> result;
+
+        for (const ThreadSchedulerStats &thread : threadStats)
+            result.push_back(thread.stats);
+
+        return result;
+    }
+
+private:
+    bool steal(int thread, int &tile)
+    {
+        for (int offset = 1; offset < teamSize; ++offset)
+        {
+            if (deques[(thread + offset) % teamSize].popFront(tile))
+                return true;
+        }
+
+        return false;
+    }
+
+    vector<TileDeque> deques;
+    vector<ThreadSchedulerStats> threadStats;
+    int tileCount = 0;
+    int teamSize = 1;
+    alignas(cacheLineSize) atomic<int> remaining{0};
+};
@@ -0,0 +1,731 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "helper_functions.cpp"
+#include "config.cpp"
+#include "tuning.cpp"
+
+using namespace std;
+
+/**
+ * Mean, percentiles and maximum of a set of latencies in seconds
+ */
+struct LatencySummary
+{
+    double mean = NAN;
+    double p50 = NAN;
+    double p90 = NAN;
+    double p99 = NAN;
+    double max = NAN;
+};
+
+/**
+ * Nearest-rank percentile q in [0, 1] of sorted values
+ */
+inline double percentile(const vector<double> &sorted, double q)
+{
+    if (sorted.empty())
+        return NAN;
+
+    const size_t rank = size_t(ceil(q * sorted.size()));
+
+    return sorted[clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+inline LatencySummary summarizeLatency(vector<double> values)
+{
+    LatencySummary summary;
+
+    if (values.empty())
+        return summary;
+
+    sort(values.begin(), values.end());
+
+    summary.mean = 0.0;
+
+    for (double value : values)
+        summary.mean += value / values.size();
+
+    summary.p50 = percentile(values, 0.50);
+    summary.p90 = percentile(values, 0.90);
+    summary.p99 = percentile(values, 0.99);
+    summary.max = values.back();
+
+    return summary;
+}
+
+/**
+ * What the job scheduler has done since it started
+ */
+struct ServiceStats
+{
+    long completed = 0;
+    long queued = 0;
+    long running = 0;
+    double seconds = 0.0;
+    double jobsPerSecond = 0.0;
+    // From submission to start, and from submission to the end of the job
+    LatencySummary queue;
+    LatencySummary latency;
+};
+
+/**
+ * Runs jobs concurrently on a shared pool of threads, every job taking the threads it asks for while it runs
+ * Jobs start in submission order, the first one waits until enough threads are free so large jobs do not starve.
+ * One worker per pool thread takes the jobs, so the thread budget alone limits how many run at once.
+ */
+class JobScheduler
+{
+public:
+    // Called with the seconds the job waited in the queue
+    using Work = function<void(double)>;
+
+    explicit JobScheduler(int threads) : freeThreads(threads), poolThreads(threads), started(chrono::steady_clock::now())
+    {
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back([this]
+                                 { work(); });
+    }
+
+    ~JobScheduler()
+    {
+        {
+            lock_guard guard(lock);
+            stopping = true;
+        }
+
+        changed.notify_all();
+
+        for (thread &worker : workers)
+            worker.join();
+    }
+
+    int capacity() const
+    {
+        return poolThreads;
+    }
+
+    /**
+     * Queue a job that needs threads of the pool, at most its capacity
+     */
+    void submit(int threads, Work job)
+    {
+        {
+            lock_guard guard(lock);
+            queue.push_back({min(threads, poolThreads), move(job), chrono::steady_clock::now()});
+        }
+
+        changed.notify_all();
+    }
+
+    /**
+     * Wait until every submitted job has finished
+     */
+    void drain()
+    {
+        unique_lock guard(lock);
+        changed.wait(guard, [&]
+                     { return queue.empty() && running == 0; });
+    }
+
+    ServiceStats stats()
+    {
+        lock_guard guard(lock);
+        ServiceStats stats;
+
+        stats.completed = queueSeconds.size();
+        stats.queued = queue.size();
+        stats.running = running;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        stats.jobsPerSecond = stats.completed / stats.seconds;
+        stats.queue = summarizeLatency(queueSeconds);
+        stats.latency = summarizeLatency(latencySeconds);
+
+        return stats;
+    }
+
+private:
+    struct Job
+    {
+        int threads;
+        Work work;
+        chrono::steady_clock::time_point submitted;
+    };
+
+    void work()
+    {
+        unique_lock guard(lock);
+
+        while (true)
+        {
+            changed.wait(guard, [&]
+                         { return (!queue.empty() && queue.front().threads <= freeThreads) || (stopping && queue.empty()); });
+
+            if (queue.empty())
+                return;
+
+            Job job = move(queue.front());
+            queue.pop_front();
+            freeThreads -= job.threads;
+            ++running;
+
+            const double waited = chrono::duration<double>(chrono::steady_clock::now() - job.submitted).count();
+
+            // The next job may fit into the threads still free
+            changed.notify_all();
+            guard.unlock();
+
+            job.work(waited);
+
+            guard.lock();
+            freeThreads += job.threads;
+            --running;
+            queueSeconds.push_back(waited);
+            latencySeconds.push_back(chrono::duration<double>(chrono::steady_clock::now() - job.submitted).count());
+            changed.notify_all();
+        }
+    }
+
+    mutex lock;
+    condition_variable changed;
+    deque<Job> queue;
+    int freeThreads;
+    int running = 0;
+    bool stopping = false;
+    const int poolThreads;
+    const chrono::steady_clock::time_point started;
+    vector<double> queueSeconds;
+    vector<double> latencySeconds;
+    vector<thread> workers;
+};
+
+#ifdef __linux__
+/**
+ * One client of the service socket, sends its results a line at a time
+ * Shared by the jobs of the client, so the socket stays open until the last of them has answered
+ */
+class ServiceConnection
+{
+public:
+    explicit ServiceConnection(int fd) : fd(fd)
+    {
+    }
+
+    ~ServiceConnection()
+    {
+        close(fd);
+    }
+
+    /**
+     * Next line the client sent without its newline, false once the client stopped sending
+     */
+    bool readLine(string &line)
+    {
+        while (true)
+        {
+            const size_t end = buffer.find('\n');
+
+            if (end != string::npos)
+            {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                return true;
+            }
+
+            char chunk[4096];
+            const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+
+            if (count <= 0)
+            {
+                // A last line without a newline still counts
+                line = move(buffer);
+                buffer.clear();
+                return !line.empty();
+            }
+
+            buffer.append(chunk, count);
+        }
+    }
+
+    /**
+     * Send a line, dropped when the client has gone away
+     */
+    void send(const string &line)
+    {
+        lock_guard guard(lock);
+        const string text = line + "\n";
+
+        for (size_t sent = 0; sent < text.size();)
+        {
+            const ssize_t count = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+
+            if (count <= 0)
+                return;
+
+            sent += count;
+        }
+    }
+
+    /**
+     * Stop reading, a reader blocked on the client returns
+     */
+    void stopReading()
+    {
+        shutdown(fd, SHUT_RD);
+    }
+
+private:
+    const int fd;
+    string buffer;
+    mutex lock;
+};
+
+/**
+ * Local socket the service listens on, removed again when the service stops
+ */
+class ServiceSocket
+{
+public:
+    explicit ServiceSocket(const string &path) : path(path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path))
+            throw runtime_error("socket path " + path + " is too long");
+
+        copy(path.begin(), path.end(), address.sun_path);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd < 0)
+            throw runtime_error("cannot create a socket");
+
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0)
+        {
+            close(fd);
+            throw runtime_error("cannot listen on " + path + ", is another service using it?");
+        }
+    }
+
+    ~ServiceSocket()
+    {
+        close(fd);
+        unlink(path.c_str());
+    }
+
+    /**
+     * Next client, null once the socket was stopped
+     */
+    shared_ptr<ServiceConnection> accept()
+    {
+        while (true)
+        {
+            const int client = ::accept(fd, nullptr, nullptr);
+
+            if (client >= 0)
+                return make_shared<ServiceConnection>(client);
+
+            if (errno != EINTR && errno != ECONNABORTED)
+                return nullptr;
+        }
+    }
+
+    /**
+     * Stop accepting clients, a blocked accept returns null
+     */
+    void stop()
+    {
+        shutdown(fd, SHUT_RDWR);
+    }
+
+private:
+    const string path;
+    int fd;
+};
+#endif
+
+const string precisionNames[] = {"double", "single", "mixed"};
+
+inline Precision parsePrecision(const string &name)
+{
+    for (int precision = 0; precision < 3; ++precision)
+    {
+        if (precisionNames[precision] == name)
+            return Precision(precision);
+    }
+
+    throw runtime_error("unknown precision " + name + ", expected double, single or mixed");
+}
+
+/**
+ * One job of the service, a single run of a function and variant
+ */
+struct ServiceJob
+{
+    string id;
+    FunctionBenchmark func;
+    Variant variant;
+    int threads = 1;
+};
+
+/**
+ * What the service was started with, a job takes every setting its line leaves out from here
+ */
+struct ServiceSettings
+{
+    // "stdin" or the path of the Unix socket the jobs arrive on
+    string input;
+    // Threads of the pool the jobs share
+    int threads = 1;
+    // Functions and variants a job can name, and the ones it runs when it names none
+    vector<FunctionBenchmark> functions;
+    vector<Variant> variants;
+    FunctionBenchmark func;
+    Variant variant;
+    // Functions defined for their table dimension only
+    vector<string> fixedDimensionFunctions;
+    // A job's default seed is this plus the job number
+    uint64_t seed = 0;
+    // Settings the tuner stored for a function and variant on this host
+    function<optional<TunedSetting>(const FunctionBenchmark &, const Variant &)> tuned;
+};
+
+/**
+ * Parse a job line of space separated key=value settings, values with spaces in double quotes, for example
+ * id=a function=rastrigin dim=10 range=-5,5 variant="SoA batch" precision=single evaluations=200000 seed=7 threads=2
+ * Unset keys take the settings the service was started with, the default seed is the service seed plus the job number.
+ * A job without threads runs with the thread count and loop schedule tuned for its function and variant, one thread when untuned.
+ */
+inline ServiceJob parseJob(const ServiceSettings &settings, const string &line, long number, int poolThreads)
+{
+    ServiceJob job{.id = to_string(number), .func = settings.func, .variant = settings.variant};
+
+    string functionName;
+    int dim = 0;
+    pair<double, double> range;
+    bool hasRange = false;
+    // Applied after the variant, whichever comes first on the line
+    FireflyOptions stopping{.seed = settings.seed + number};
+    optional<Precision> precision;
+    optional<int> threads;
+
+    for (const string &item : splitWords(line))
+    {
+        const size_t equals = item.find('=');
+
+        if (equals == string::npos)
+            throw runtime_error("expected key=value, got " + item);
+
+        const Setting setting{item.substr(0, equals), item.substr(equals + 1)};
+        const string &key = setting.key;
+
+        if (key == "id")
+            job.id = setting.value;
+        else if (key == "function")
+            functionName = setting.value;
+        else if (key == "variant")
+            job.variant = findByName(settings.variants, setting.value, "variant");
+        else if (key == "dim")
+            dim = parseNumber<int>(setting);
+        else if (key == "range")
+        {
+            vector<double> bounds = parseNumberList<double>(setting);
+
+            if (bounds.size() != 2 || bounds[0] >= bounds[1])
+                throw runtime_error("range needs lo,hi with lo < hi");
+
+            range = {bounds[0], bounds[1]};
+            hasRange = true;
+        }
+        else if (key == "precision")
+            precision = parsePrecision(setting.value);
+        else if (key == "threads")
+            threads = parseNumber<int>(setting);
+        else if (key == "seed")
+            stopping.seed = parseNumber<uint64_t>(setting);
+        else if (key == "evaluations")
+            stopping.evaluationBudget = parseNumber<long>(setting);
+        else if (key == "seconds")
+            stopping.timeBudgetSeconds = parseNumber<double>(setting);
+        else if (key == "target")
+            stopping.stopAtTarget = parseSwitch(setting);
+        else if (key == "stagnation")
+            stopping.stagnationGenerations = parseNumber<int>(setting);
+        else
+            throw runtime_error("unknown job setting " + key);
+    }
+
+    if (!functionName.empty())
+        job.func = findByName(settings.functions, functionName, "function");
+
+    if (dim > 0)
+    {
+        if (dim != job.func.dim && find(settings.fixedDimensionFunctions.begin(), settings.fixedDimensionFunctions.end(), job.func.name) != settings.fixedDimensionFunctions.end())
+            throw runtime_error(job.func.name + " is only defined for dimension " + to_string(job.func.dim));
+
+        job.func.dim = dim;
+    }
+
+    if (hasRange)
+        tie(job.func.min_range, job.func.max_range) = range;
+
+    if (stopping.stopAtTarget && !job.func.optimum(job.func.dim))
+        throw runtime_error("target needs the optimum of " + job.func.name + ", which is not known at dimension " + to_string(job.func.dim));
+
+    if (const optional<TunedSetting> tuned = settings.tuned(job.func, job.variant))
+    {
+        job.threads = min(tuned->threads, poolThreads);
+        job.variant.options.schedule = tuned->schedule;
+        job.variant.options.chunkSize = tuned->chunkSize;
+    }
+
+    if (threads)
+        job.threads = *threads;
+
+    if (job.threads < 1 || job.threads > poolThreads)
+        throw runtime_error("threads must be between 1 and the " + to_string(poolThreads) + " of the pool");
+
+    if (stopping.evaluationBudget < 0 || stopping.timeBudgetSeconds < 0.0 || stopping.stagnationGenerations < 0)
+        throw runtime_error("evaluations, seconds and stagnation must not be negative");
+
+    // Worker processes would be started with the service's own arguments
+    if (job.variant.options.transport == IslandTransport::Processes)
+        throw runtime_error("island processes are not available to jobs");
+
+    if (precision)
+        job.variant.options.precision = *precision;
+
+    job.variant.options.seed = stopping.seed;
+    job.variant.options.evaluationBudget = stopping.evaluationBudget;
+    job.variant.options.timeBudgetSeconds = stopping.timeBudgetSeconds;
+    job.variant.options.stopAtTarget = stopping.stopAtTarget;
+    job.variant.options.stagnationGenerations = stopping.stagnationGenerations;
+
+    return job;
+}
+
+/**
+ * Result line of a finished job
+ */
+inline string jobResultJSON(const ServiceJob &job, const FireflyResult &result, double queueSeconds, double runSeconds)
+{
+    ostringstream line;
+
+    line << "{\"id\": " << jsonString(job.id)
+         << ", \"function\": " << jsonString(job.func.name)
+         << ", \"variant\": " << jsonString(job.variant.name)
+         << ", \"precision\": " << jsonString(precisionNames[int(job.variant.options.precision)])
+         << ", \"dim\": " << job.func.dim
+         << ", \"threads\": " << job.threads
+         << ", \"seed\": " << job.variant.options.seed
+         << ", \"bestFitness\": " << jsonNumber(result.bestFitness)
+         << ", \"evaluations\": " << result.evaluations
+         << ", \"generations\": " << result.generations
+         << ", \"targetHit\": " << (result.target.hit ? "true" : "false")
+         << ", \"queueSeconds\": " << jsonNumber(queueSeconds)
+         << ", \"runSeconds\": " << jsonNumber(runSeconds) << "}";
+
+    return line.str();
+}
+
+inline string jobErrorJSON(const string &id, const string &error)
+{
+    return "{\"id\": " + jsonString(id) + ", \"error\": " + jsonString(error) + "}";
+}
+
+inline string latencyJSON(const LatencySummary &summary)
+{
+    return "{\"mean\": " + jsonNumber(summary.mean) + ", \"p50\": " + jsonNumber(summary.p50) + ", \"p90\": " + jsonNumber(summary.p90) +
+           ", \"p99\": " + jsonNumber(summary.p99) + ", \"max\": " + jsonNumber(summary.max) + "}";
+}
+
+inline string serviceStatsJSON(const ServiceStats &stats)
+{
+    return "{\"stats\": {\"completed\": " + to_string(stats.completed) + ", \"queued\": " + to_string(stats.queued) +
+           ", \"running\": " + to_string(stats.running) + ", \"seconds\": " + jsonNumber(stats.seconds) +
+           ", \"jobsPerSecond\": " + jsonNumber(stats.jobsPerSecond) + ", \"queueSeconds\": " + latencyJSON(stats.queue) +
+           ", \"latencySeconds\": " + latencyJSON(stats.latency) + "}}";
+}
+
+/**
+ * Print the service statistics when it stops, on stderr so stdout holds only results
+ */
+inline void printServiceStats(const ServiceStats &stats)
+{
+    auto row = [](const string &name, const LatencySummary &summary)
+    {
+        cerr << name << ": mean " << summary.mean << "s, p50 " << summary.p50 << "s, p90 " << summary.p90 << "s, p99 " << summary.p99
+             << "s, max " << summary.max << "s" << endl;
+    };
+
+    cerr << "Jobs: " << stats.completed << " in " << stats.seconds << "s, " << stats.jobsPerSecond << " jobs/s" << endl;
+    row("Queue latency", stats.queue);
+    row("Job latency", stats.latency);
+}
+
+/**
+ * Handle one line of a client, a job is queued and answered through respond when it finishes
+ * "stats" answers with the statistics so far, a blank line is ignored
+ */
+inline void handleServiceLine(const ServiceSettings &settings, JobScheduler &scheduler, const string &text, long &jobNumber, function<void(const string &)> respond)
+{
+    const string line = trim(text);
+
+    if (line.empty())
+        return;
+
+    if (line == "stats")
+    {
+        respond(serviceStatsJSON(scheduler.stats()));
+        return;
+    }
+
+    const long number = jobNumber++;
+    shared_ptr<ServiceJob> job;
+
+    try
+    {
+        job = make_shared<ServiceJob>(parseJob(settings, line, number, scheduler.capacity()));
+    }
+    catch (const exception &error)
+    {
+        respond(jobErrorJSON(to_string(number), error.what()));
+        return;
+    }
+
+    scheduler.submit(job->threads, [job, respond](double queueSeconds)
+                     {
+                         try
+                         {
+                             const auto start = chrono::steady_clock::now();
+                             const FireflyResult result = fireflyAlgorithm(job->func, job->threads, job->variant.options, 0);
+                             const double runSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+                             respond(jobResultJSON(*job, result, queueSeconds, runSeconds));
+                         }
+                         catch (const exception &error)
+                         {
+                             respond(jobErrorJSON(job->id, error.what()));
+                         } });
+}
+
+/**
+ * Run the job service until stdin ends or a socket client sends "shutdown", then finish the queued jobs
+ * Results go back as one JSON line each, in the order the jobs finish
+ */
+inline int runService(const ServiceSettings &settings)
+{
+    // Island variants nest a team per island
+    omp_set_max_active_levels(2);
+
+    JobScheduler scheduler(settings.threads);
+    long jobNumber = 0;
+
+    if (settings.input == "stdin")
+    {
+        mutex outputLock;
+        auto respond = [&](const string &line)
+        {
+            lock_guard guard(outputLock);
+            cout << line << endl;
+        };
+
+        for (string line; getline(cin, line);)
+            handleServiceLine(settings, scheduler, line, jobNumber, respond);
+
+        scheduler.drain();
+        respond(serviceStatsJSON(scheduler.stats()));
+        printServiceStats(scheduler.stats());
+
+        return 0;
+    }
+
+#ifdef __linux__
+    ServiceSocket socket(settings.input);
+    mutex jobNumberLock;
+
+    // Weak, a client's socket closes once it stopped sending and its last job has answered
+    vector<weak_ptr<ServiceConnection>> clients;
+    vector<pair<thread, shared_ptr<atomic<bool>>>> readers;
+
+    cerr << "Listening on " << settings.input << " with " << settings.threads << " threads" << endl;
+
+    while (shared_ptr<ServiceConnection> client = socket.accept())
+    {
+        // Join the readers of clients that have stopped sending
+        for (auto &[reader, done] : readers)
+        {
+            if (*done)
+                reader.join();
+        }
+
+        erase_if(readers, [](const auto &reader)
+                 { return !reader.first.joinable(); });
+        erase_if(clients, [](const weak_ptr<ServiceConnection> &client)
+                 { return client.expired(); });
+
+        clients.push_back(client);
+        auto done = make_shared<atomic<bool>>(false);
+
+        readers.emplace_back(thread([&, client, done]
+                                    {
+                                        auto respond = [client](const string &line)
+                                        { client->send(line); };
+
+                                        for (string line; client->readLine(line);)
+                                        {
+                                            if (trim(line) == "shutdown")
+                                            {
+                                                socket.stop();
+                                                break;
+                                            }
+
+                                            lock_guard guard(jobNumberLock);
+                                            handleServiceLine(settings, scheduler, line, jobNumber, respond);
+                                        }
+
+                                        *done = true; }),
+                             done);
+    }
+
+    // No more clients, stop reading from the ones still connected and finish what they queued
+    for (const weak_ptr<ServiceConnection> &client : clients)
+    {
+        if (shared_ptr<ServiceConnection> connection = client.lock())
+            connection->stopReading();
+    }
+
+    for (auto &[reader, done] : readers)
+        reader.join();
+
+    scheduler.drain();
+    printServiceStats(scheduler.stats());
+
+    return 0;
+#else
+    throw runtime_error("the socket service needs Linux");
+#endif
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * Thin wrappers over the widest double precision registers the target supports
+ * Kernels are written once against this interface and instantiated for SimdDouble and ScalarDouble
+ * Loads from float storage widen every value to double, so float data runs through the same kernels
+ */
+struct ScalarDouble
+{
+    static constexpr int width = 1;
+
+    double v;
+
+    ScalarDouble() = default;
+    ScalarDouble(double x) : v(x) {}
+
+    static ScalarDouble load(const double *p) { return p[0]; }
+    static ScalarDouble load(const float *p) { return double(p[0]); }
+    void store(double *p) const { p[0] = v; }
+};
+
+inline ScalarDouble operator+(ScalarDouble a, ScalarDouble b) { return a.v + b.v; }
+inline ScalarDouble operator-(ScalarDouble a, ScalarDouble b) { return a.v - b.v; }
+inline ScalarDouble operator*(ScalarDouble a, ScalarDouble b) { return a.v * b.v; }
+inline ScalarDouble operator/(ScalarDouble a, ScalarDouble b) { return a.v / b.v; }
+inline ScalarDouble fma(ScalarDouble a, ScalarDouble b, ScalarDouble c) { return a.v * b.v + c.v; }
+inline ScalarDouble abs(ScalarDouble a) { return fabs(a.v); }
+inline ScalarDouble max(ScalarDouble a, ScalarDouble b) { return a.v > b.v ? a.v : b.v; }
+inline ScalarDouble min(ScalarDouble a, ScalarDouble b) { return a.v < b.v ? a.v : b.v; }
+inline ScalarDouble sqrt(ScalarDouble a) { return sqrt(a.v); }
+inline ScalarDouble equalAsOne(ScalarDouble a, ScalarDouble b) { return a.v == b.v ? 1.0 : 0.0; }
+inline double reduceAdd(ScalarDouble a) { return a.v; }
+inline ScalarDouble nearest(ScalarDouble a) { return nearbyint(a.v); }
+inline ScalarDouble scale2(ScalarDouble a, ScalarDouble n) { return ldexp(a.v, int(n.v)); }
+inline ScalarDouble sqrtApprox(ScalarDouble a) { return sqrt(a.v); }
+
+#if defined(__AVX512F__)
+
+struct SimdDouble
+{
+    static constexpr int width = 8;
+
+    __m512d v;
+
+    SimdDouble() = default;
+    SimdDouble(__m512d x) : v(x) {}
+    SimdDouble(double x) : v(_mm512_set1_pd(x)) {}
+
+    static SimdDouble load(const double *p) { return _mm512_loadu_pd(p); }
+    static SimdDouble load(const float *p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+    void store(double *p) const { _mm512_storeu_pd(p, v); }
+};
+
+inline SimdDouble operator+(SimdDouble a, SimdDouble b) { return _mm512_add_pd(a.v, b.v); }
+inline SimdDouble operator-(SimdDouble a, SimdDouble b) { return _mm512_sub_pd(a.v, b.v); }
+inline SimdDouble operator*(SimdDouble a, SimdDouble b) { return _mm512_mul_pd(a.v, b.v); }
+inline SimdDouble operator/(SimdDouble a, SimdDouble b) { return _mm512_div_pd(a.v, b.v); }
+inline SimdDouble fma(SimdDouble a, SimdDouble b, SimdDouble c) { return _mm512_fmadd_pd(a.v, b.v, c.v); }
+inline SimdDouble abs(SimdDouble a) { return _mm512_abs_pd(a.v); }
+inline SimdDouble max(SimdDouble a, SimdDouble b) { return _mm512_max_pd(a.v, b.v); }
+inline SimdDouble min(SimdDouble a, SimdDouble b) { return _mm512_min_pd(a.v, b.v); }
+inline SimdDouble sqrt(SimdDouble a) { return _mm512_sqrt_pd(a.v); }
+inline SimdDouble equalAsOne(SimdDouble a, SimdDouble b) { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ), _mm512_set1_pd(1.0)); }
+inline double reduceAdd(SimdDouble a) { return _mm512_reduce_add_pd(a.v); }
+inline SimdDouble nearest(SimdDouble a) { return _mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+inline SimdDouble scale2(SimdDouble a, SimdDouble n) { return _mm512_scalef_pd(a.v, n.v); }
+inline SimdDouble sqrtApprox(SimdDouble a)
+{
+    // 14-bit reciprocal square root and one Newton step, about 28 bits; the floor keeps sqrt(0) at 0
+    __m512d x = _mm512_max_pd(a.v, _mm512_set1_pd(1e-300));
+    __m512d y = _mm512_rsqrt14_pd(x);
+    y = _mm512_mul_pd(y, _mm512_fnmadd_pd(_mm512_mul_pd(_mm512_set1_pd(0.5), x), _mm512_mul_pd(y, y), _mm512_set1_pd(1.5)));
+    return _mm512_mul_pd(a.v, y);
+}
+
+#elif defined(__AVX2__)
+
+struct SimdDouble
+{
+    static constexpr int width = 4;
+
+    __m256d v;
+
+    SimdDouble() = default;
+    SimdDouble(__m256d x) : v(x) {}
+    SimdDouble(double x) : v(_mm256_set1_pd(x)) {}
+
+    static SimdDouble load(const double *p) { return _mm256_loadu_pd(p); }
+    static SimdDouble load(const float *p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    void store(double *p) const { _mm256_storeu_pd(p, v); }
+};
+
+inline SimdDouble operator+(SimdDouble a, SimdDouble b) { return _mm256_add_pd(a.v, b.v); }
+inline SimdDouble operator-(SimdDouble a, SimdDouble b) { return _mm256_sub_pd(a.v, b.v); }
+inline SimdDouble operator*(SimdDouble a, SimdDouble b) { return _mm256_mul_pd(a.v, b.v); }
+inline SimdDouble operator/(SimdDouble a, SimdDouble b) { return _mm256_div_pd(a.v, b.v); }
+#if defined(__FMA__)
+inline SimdDouble fma(SimdDouble a, SimdDouble b, SimdDouble c) { return _mm256_fmadd_pd(a.v, b.v, c.v); }
+#else
+inline SimdDouble fma(SimdDouble a, SimdDouble b, SimdDouble c) { return _mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v); }
+#endif
+inline SimdDouble abs(SimdDouble a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+inline SimdDouble max(SimdDouble a, SimdDouble b) { return _mm256_max_pd(a.v, b.v); }
+inline SimdDouble min(SimdDouble a, SimdDouble b) { return _mm256_min_pd(a.v, b.v); }
+inline SimdDouble sqrt(SimdDouble a) { return _mm256_sqrt_pd(a.v); }
+inline SimdDouble equalAsOne(SimdDouble a, SimdDouble b) { return _mm256_and_pd(_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ), _mm256_set1_pd(1.0)); }
+inline double reduceAdd(SimdDouble a)
+{
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(a.v), _mm256_extractf128_pd(a.v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+inline SimdDouble nearest(SimdDouble a) { return _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+inline SimdDouble scale2(SimdDouble a, SimdDouble n)
+{
+    // n is integral, adding 1.5 * 2^52 puts it in the low mantissa bits, from where it is shifted into an exponent
+    const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+    __m256i bits = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n.v, magic)), _mm256_castpd_si256(magic));
+    bits = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(a.v, _mm256_castsi256_pd(bits));
+}
+// No double precision reciprocal square root below AVX-512
+inline SimdDouble sqrtApprox(SimdDouble a) { return _mm256_sqrt_pd(a.v); }
+
+#else
+
+using SimdDouble = ScalarDouble;
+
+#endif
+
+/**
+ * Apply a scalar function to every lane, used for operations without a vector instruction
+ */
+template <typename V, typename F>
+inline V lanewise(V x, F f)
+{
+    alignas(64) double lanes[V::width];
+    x.store(lanes);
+
+    for (int l = 0; l < V::width; ++l)
+        lanes[l] = f(lanes[l]);
+
+    return V::load(lanes);
+}
+
+/**
+ * Square without going through pow
+ */
+template <typename V>
+inline V square(V x)
+{
+    return x * x;
+}
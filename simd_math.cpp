@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "simd.cpp"
+
+using namespace std;
+
+/**
+ * How the objectives evaluate sin, cos, exp and sqrt
+ */
+enum class MathMode
+{
+    // Call libm lane by lane, the reference the other modes are measured against
+    Libm,
+    // In-tree polynomials within a few ulp of libm over the ranges the objectives use
+    Precise,
+    // Shorter polynomials and an approximate square root, around 1e-7 relative error
+    Fast
+};
+
+const string mathModeNames[] = {"libm", "precise", "fast"};
+
+// Set once from the configuration before any evaluation
+inline MathMode mathMode = MathMode::Libm;
+
+/**
+ * x^N by repeated squaring, for doubles and vectors alike
+ */
+template <int N, typename V>
+inline V ipow(V x)
+{
+    static_assert(N >= 1, "ipow needs a positive exponent");
+
+    if constexpr (N == 1)
+        return x;
+    else if constexpr (N % 2 == 0)
+    {
+        V half = ipow<N / 2>(x);
+        return half * half;
+    }
+    else
+        return ipow<N - 1>(x) * x;
+}
+
+// pi in two parts, fma rounds x - k * PI_A once and PI_B carries the rest of pi
+constexpr double PI_A = 3.141592653589793;
+constexpr double PI_B = 1.2246467991473532e-16;
+
+constexpr double LN2_HI = 0.6931471805599453;
+constexpr double LN2_LO = 2.3190468138462996e-17;
+constexpr double LOG2_E = 1.4426950408889634;
+
+// The functions below are forced inline, a call per element would keep the objective loops from vectorizing
+
+/**
+ * sin(r) for r in [-pi/2, pi/2], odd Taylor polynomial up to r^19, or r^11 in fast mode
+ */
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V sinPolynomial(V r)
+{
+    constexpr double c[] = {
+        -1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0, -1.0 / 39916800.0,
+        1.0 / 6227020800.0, -1.0 / 1307674368000.0, 1.0 / 355687428096000.0, -1.0 / 121645100408832000.0};
+    constexpr int terms = Mode == MathMode::Fast ? 5 : 9;
+
+    V r2 = r * r;
+    V p = c[terms - 1];
+
+    for (int i = terms - 2; i >= 0; --i)
+        p = fma(p, r2, V(c[i]));
+
+    return fma(r * r2, p, r);
+}
+
+/**
+ * sin(x - k * pi) times the sign of that half period, k an integer or an integer plus one half
+ */
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V reducedSine(V x, V k, V q)
+{
+    V r = fma(V(0.0) - k, V(PI_A), x);
+    r = fma(V(0.0) - k, V(PI_B), r);
+
+    // Rounding of k can leave r a hair outside the interval the polynomial is fitted on
+    r = min(max(r, V(-PI_A / 2)), V(PI_A / 2));
+
+    // -1 for odd q, 1 for even q
+    V sign = V(1.0) - V(2.0) * abs(q - V(2.0) * nearest(V(0.5) * q));
+
+    return sign * sinPolynomial<Mode>(r);
+}
+
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V vsin(V x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return lanewise(x, [](double a) { return sin(a); });
+    else
+    {
+        V q = nearest(x * V(1.0 / PI_A));
+        return reducedSine<Mode>(x, q, q);
+    }
+}
+
+/**
+ * cos(x) = sin(x - (q + 1/2) pi) with the sign of q + 1
+ */
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V vcos(V x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return lanewise(x, [](double a) { return cos(a); });
+    else
+    {
+        V q = nearest(fma(x, V(1.0 / PI_A), V(-0.5)));
+        return reducedSine<Mode>(x, q + V(0.5), q + V(1.0));
+    }
+}
+
+/**
+ * exp(x) = 2^n exp(r) with |r| <= ln2 / 2, Taylor polynomial up to r^13, or r^6 in fast mode
+ * Inputs are clamped to the range where the result is a normal double
+ */
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V vexp(V x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return lanewise(x, [](double a) { return exp(a); });
+    else
+    {
+        constexpr double c[] = {
+            1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0, 1.0 / 5040.0,
+            1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0, 1.0 / 39916800.0, 1.0 / 479001600.0, 1.0 / 6227020800.0};
+        constexpr int terms = Mode == MathMode::Fast ? 7 : 14;
+
+        x = min(max(x, V(-708.0)), V(709.0));
+
+        V n = nearest(x * V(LOG2_E));
+        V r = fma(V(0.0) - n, V(LN2_HI), x);
+        r = fma(V(0.0) - n, V(LN2_LO), r);
+
+        V p = c[terms - 1];
+
+        for (int i = terms - 2; i >= 0; --i)
+            p = fma(p, r, V(c[i]));
+
+        return scale2(p, n);
+    }
+}
+
+/**
+ * Hardware square root, or the reciprocal square root estimate where the target has one in fast mode
+ */
+template <MathMode Mode, typename V>
+[[gnu::always_inline]] inline V vsqrt(V x)
+{
+    if constexpr (Mode == MathMode::Fast)
+        return sqrtApprox(x);
+    else
+        return sqrt(x);
+}
+
+/**
+ * The same functions on plain scalars, for the scalar objectives, libm mode calls libm directly
+ * Floats go through the double polynomials and are rounded once at the end
+ */
+template <MathMode Mode, typename T>
+[[gnu::always_inline]] inline T scalarSin(T x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return sin(x);
+    else
+        return T(vsin<Mode>(ScalarDouble(x)).v);
+}
+
+template <MathMode Mode, typename T>
+[[gnu::always_inline]] inline T scalarCos(T x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return cos(x);
+    else
+        return T(vcos<Mode>(ScalarDouble(x)).v);
+}
+
+template <MathMode Mode, typename T>
+[[gnu::always_inline]] inline T scalarExp(T x)
+{
+    if constexpr (Mode == MathMode::Libm)
+        return exp(x);
+    else
+        return T(vexp<Mode>(ScalarDouble(x)).v);
+}
+
+template <MathMode Mode, typename T>
+[[gnu::always_inline]] inline T scalarSqrt(T x)
+{
+    return T(vsqrt<Mode>(ScalarDouble(x)).v);
+}
+
+inline MathMode parseMathMode(const string &name)
+{
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        if (mathModeNames[mode] == name)
+            return MathMode(mode);
+    }
+
+    throw runtime_error("unknown math mode " + name + ", expected libm, precise or fast");
+}
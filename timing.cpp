@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std;
+
+/**
+ * CPU time of the whole process, summed over all its threads, in seconds
+ */
+inline double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+    auto seconds = [](FILETIME time)
+    {
+        return (double(time.dwHighDateTime) * 4294967296.0 + time.dwLowDateTime) * 1e-7;
+    };
+
+    return seconds(kernel) + seconds(user);
+#else
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+inline double median(vector<double> values)
+{
+    if (values.empty())
+        return NAN;
+
+    const size_t middle = values.size() / 2;
+    nth_element(values.begin(), values.begin() + middle, values.end());
+
+    if (values.size() % 2 == 1)
+        return values[middle];
+
+    return (values[middle] + *max_element(values.begin(), values.begin() + middle)) / 2.0;
+}
+
+inline SampleStatistics summarize(const vector<double> &samples)
+{
+    SampleStatistics statistics;
+
+    if (samples.empty())
+        return statistics;
+
+    statistics.median = median(samples);
+    statistics.min = *min_element(samples.begin(), samples.end());
+
+    for (double sample : samples)
+        statistics.mean += sample;
+
+    statistics.mean /= samples.size();
+
+    for (double sample : samples)
+        statistics.stddev += (sample - statistics.mean) * (sample - statistics.mean);
+
+    // Sample standard deviation, zero for a single sample
+    statistics.stddev = samples.size() > 1 ? sqrt(statistics.stddev / (samples.size() - 1)) : 0.0;
+
+    return statistics;
+}
+
+struct ConfidenceInterval
+{
+    double low;
+    double high;
+};
+
+/**
+ * Percentile bootstrap confidence interval of the speedup median(baseline) / median(samples)
+ * Both sample sets are resampled with replacement, the generator is seeded so the interval is reproducible
+ */
+inline ConfidenceInterval bootstrapSpeedup(const vector<double> &baseline, const vector<double> &samples, int resamples = 2000, double confidence = 0.95, uint64_t seed = 0)
+{
+    if (baseline.empty() || samples.empty())
+        return {NAN, NAN};
+
+    mt19937_64 rng(seed);
+    uniform_int_distribution<size_t> pickBaseline(0, baseline.size() - 1);
+    uniform_int_distribution<size_t> pickSample(0, samples.size() - 1);
+
+    vector<double> speedups(resamples);
+    vector<double> baselineDraw(baseline.size());
+    vector<double> sampleDraw(samples.size());
+
+    for (double &speedup : speedups)
+    {
+        for (double &value : baselineDraw)
+            value = baseline[pickBaseline(rng)];
+
+        for (double &value : sampleDraw)
+            value = samples[pickSample(rng)];
+
+        speedup = median(baselineDraw) / median(sampleDraw);
+    }
+
+    sort(speedups.begin(), speedups.end());
+
+    const double tail = (1.0 - confidence) / 2.0;
+    const size_t low = size_t(tail * (resamples - 1));
+    const size_t high = size_t((1.0 - tail) * (resamples - 1));
+
+    return {speedups[low], speedups[high]};
+}
@@ -0,0 +1,420 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "helper_functions.cpp"
+#include "config.cpp"
+#include "affinity.cpp"
+#include "profile.cpp"
+#include "checkpoint.cpp"
+#include "timing.cpp"
+
+using namespace std;
+
+const string scheduleNames[] = {"static", "dynamic", "guided"};
+
+inline LoopSchedule parseSchedule(const string &name)
+{
+    for (int schedule = 0; schedule < 3; ++schedule)
+    {
+        if (scheduleNames[schedule] == name)
+            return LoopSchedule(schedule);
+    }
+
+    throw runtime_error("unknown schedule " + name + ", expected static, dynamic or guided");
+}
+
+/**
+ * Schedule of the schedule(runtime) loops in the parallel regions the calling thread opens from now on
+ */
+inline void applySchedule(LoopSchedule schedule, int chunkSize)
+{
+    const omp_sched_t kinds[] = {omp_sched_static, omp_sched_dynamic, omp_sched_guided};
+
+    omp_set_schedule(kinds[int(schedule)], chunkSize);
+}
+
+/**
+ * Model name of the first CPU, as the kernel reports it
+ */
+inline string cpuModel()
+{
+#ifdef __linux__
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+
+    while (getline(cpuinfo, line))
+    {
+        if (line.rfind("model name", 0) == 0 && line.find(':') != string::npos)
+            return trim(line.substr(line.find(':') + 1));
+    }
+#endif
+
+    return "unknown CPU";
+}
+
+/**
+ * Compiler and the code generation flags visible to the preprocessor, the ones that change how fast a build runs
+ */
+inline string buildFlags()
+{
+    string flags;
+
+#if defined(__clang__)
+    flags = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    flags = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    flags = "msvc " + to_string(_MSC_VER);
+#else
+    flags = "unknown compiler";
+#endif
+
+#ifdef __OPTIMIZE__
+    flags += " optimized";
+#endif
+#ifdef __FAST_MATH__
+    flags += " fast-math";
+#endif
+#if defined(__AVX512F__)
+    flags += " avx512";
+#elif defined(__AVX2__)
+    flags += " avx2";
+#endif
+#ifdef __FMA__
+    flags += " fma";
+#endif
+
+    if (phaseTimersEnabled)
+        flags += " phase-timers";
+
+    return flags;
+}
+
+/**
+ * Machine and build a tuning profile entry is valid for, described in full and as the fingerprint entries are keyed by
+ */
+struct TuningHost
+{
+    string description;
+    string id;
+};
+
+inline TuningHost tuningHost(const Topology &topology)
+{
+    TuningHost host;
+    host.description = cpuModel() + ", " + to_string(topology.cores) + " cores, " + buildFlags();
+
+    ostringstream id;
+    id << hex << setw(16) << setfill('0') << fnv1a(host.description);
+    host.id = id.str();
+
+    return host;
+}
+
+/**
+ * Configuration the tuner picked for a function and variant on one host
+ */
+struct TunedSetting
+{
+    int threads = 1;
+    LoopSchedule schedule = LoopSchedule::Dynamic;
+    int chunkSize = 1;
+    // Median time of the winning probe
+    double seconds = 0.0;
+};
+
+/**
+ * Tuned settings of any number of hosts, stored as the key = value lines of a config file
+ * An entry is keyed host.function.variant and holds threads, schedule, chunk size and probe seconds,
+ * a host.host line describes every host. Entries of other hosts are kept when the file is rewritten.
+ */
+class TuningProfile
+{
+public:
+    /**
+     * Read a profile, a file that does not exist yet is an empty profile
+     */
+    void load(const string &path)
+    {
+        entries.clear();
+
+        if (!ifstream(path))
+            return;
+
+        for (const Setting &setting : readConfigFile(path))
+        {
+            try
+            {
+                if (!setting.key.ends_with(".host"))
+                    parseEntry(setting);
+            }
+            catch (const exception &error)
+            {
+                throw runtime_error(path + ": " + error.what());
+            }
+
+            entries[setting.key] = setting.value;
+        }
+    }
+
+    /**
+     * Write the profile to a temporary file renamed over path, so a reader never sees half of it
+     */
+    void save(const string &path) const
+    {
+        const string temporary = path + ".tmp";
+
+        {
+            ofstream file(temporary);
+            file << "# Tuned settings per host: threads, schedule, chunk size, probe seconds" << endl;
+
+            for (const auto &[key, value] : entries)
+                file << key << " = " << value << endl;
+
+            if (!file)
+                throw runtime_error("cannot write tuning profile " + temporary);
+        }
+
+        if (rename(temporary.c_str(), path.c_str()) != 0)
+            throw runtime_error("cannot replace tuning profile " + path);
+    }
+
+    optional<TunedSetting> find(const TuningHost &host, const string &function, const string &variant) const
+    {
+        const string key = entryKey(host, function, variant);
+        const auto entry = entries.find(key);
+
+        if (entry == entries.end())
+            return nullopt;
+
+        return parseEntry({key, entry->second});
+    }
+
+    void set(const TuningHost &host, const string &function, const string &variant, const TunedSetting &tuned)
+    {
+        ostringstream value;
+        value << tuned.threads << ", " << scheduleNames[int(tuned.schedule)] << ", " << tuned.chunkSize << ", " << setprecision(4) << tuned.seconds;
+
+        entries[host.id + ".host"] = host.description;
+        entries[entryKey(host, function, variant)] = value.str();
+    }
+
+    /**
+     * Entries of a host, its description line not included
+     */
+    int count(const TuningHost &host) const
+    {
+        int entriesOfHost = 0;
+
+        for (const auto &[key, value] : entries)
+        {
+            if (key.rfind(host.id + ".", 0) == 0 && key != host.id + ".host")
+                ++entriesOfHost;
+        }
+
+        return entriesOfHost;
+    }
+
+private:
+    static TunedSetting parseEntry(const Setting &setting)
+    {
+        const vector<string> fields = splitList(setting.value);
+
+        if (fields.size() != 4)
+            throw runtime_error("tuning profile entry " + setting.key + " needs threads, schedule, chunk size and seconds");
+
+        TunedSetting tuned{
+            .threads = parseNumber<int>(setting, fields[0]),
+            .schedule = parseSchedule(fields[1]),
+            .chunkSize = parseNumber<int>(setting, fields[2]),
+            .seconds = parseNumber<double>(setting, fields[3])};
+
+        if (tuned.threads < 1 || tuned.chunkSize < 1)
+            throw runtime_error("tuning profile entry " + setting.key + " needs at least one thread and a chunk size of at least 1");
+
+        return tuned;
+    }
+
+    static string entryKey(const TuningHost &host, const string &function, const string &variant)
+    {
+        return host.id + "." + function + "." + variant;
+    }
+
+    // Ordered by key, so the lines of a host stay together
+    map<string, string> entries;
+};
+
+/**
+ * What the tuner probes and where it stores the fastest configurations
+ */
+struct TunerSettings
+{
+    // Tuning profile the settings are saved to
+    string path;
+    vector<FunctionBenchmark> functions;
+    vector<Variant> variants;
+    vector<int> threadCounts;
+    vector<LoopSchedule> schedules;
+    vector<int> chunks;
+    // Timed runs of every probe, after one untimed run
+    int runs = 3;
+    uint64_t seed = 0;
+};
+
+/**
+ * Identify this machine and build and read the tuning profile, reporting how many of its settings apply here
+ */
+inline void loadTuningProfile(const string &path, TuningProfile &profile, TuningHost &host, ostream &out)
+{
+    if (path.empty())
+        return;
+
+    host = tuningHost(readTopology());
+    profile.load(path);
+
+    if (const int settings = profile.count(host); settings > 0)
+    {
+        out << "Tuning profile " << path << ": " << settings << " settings for " << host.description << endl;
+        out << "The loop schedule and chunk size of those functions and variants come from the profile" << endl;
+        out << endl;
+    }
+}
+
+/**
+ * Median wall time of runs runs of a function at one configuration, after an untimed run
+ */
+inline double probeSeconds(const FunctionBenchmark &func, const FireflyOptions &options, int threads, int runs)
+{
+    vector<double> samples;
+
+    for (int run = 0; run <= runs; ++run)
+    {
+        const double start = omp_get_wtime();
+        fireflyAlgorithm(func, threads, options, run);
+
+        if (run > 0)
+            samples.push_back(omp_get_wtime() - start);
+    }
+
+    return median(samples);
+}
+
+/**
+ * Probe every selected function and variant with short runs and store the fastest configuration in the tuning profile
+ * The thread counts are probed with the default schedule, then the schedules and chunk sizes at the fastest of them.
+ * Variants that spread runs over the threads or run islands as processes are left out, a job runs a single run.
+ * The probe runs take the generations the optimizer is currently set to.
+ */
+inline int runTuner(const TunerSettings &settings, TuningProfile &profile, const TuningHost &host)
+{
+    // Island variants nest a team per island
+    omp_set_max_active_levels(2);
+
+    auto start = chrono::high_resolution_clock::now();
+
+    cout << "Tuning " << host.description << endl;
+    cout << endl;
+
+    const string columns[] = {"Threads", "Schedule", "Chunk", "Probe Time", "Speedup", "Probes"};
+
+    printTitle("Tuning Table", 6);
+    printElement("Function", nameWidth);
+
+    for (const string &column : columns)
+        printElement(column, numWidth);
+
+    cout << endl;
+    cout << endl;
+
+    for (const auto &funcBenchmark : settings.functions)
+    {
+        for (const auto &variant : settings.variants)
+        {
+            printElement(funcBenchmark.name + " " + variant.name, nameWidth);
+
+            FireflyOptions options = variant.options;
+            options.seed = settings.seed;
+
+            if (options.strategy != ParallelStrategy::IntraRun || options.transport == IslandTransport::Processes)
+            {
+                for (int column = 0; column < 6; ++column)
+                    printElement("-", numWidth);
+
+                cout << endl;
+                continue;
+            }
+
+            TunedSetting best{.threads = 0};
+            double firstSeconds = 0.0;
+            int probes = 0;
+
+            for (int threads : settings.threadCounts)
+            {
+                const double seconds = probeSeconds(funcBenchmark, options, threads, settings.runs);
+                probes++;
+
+                if (probes == 1)
+                    firstSeconds = seconds;
+
+                if (best.threads == 0 || seconds < best.seconds)
+                    best = {.threads = threads, .seconds = seconds};
+            }
+
+            // Only the fork-join loop over the fireflies takes its schedule from the options
+            if (best.threads > 1 && options.update != UpdateMode::Tiled && options.team == ThreadTeam::ForkJoin)
+            {
+                for (LoopSchedule schedule : settings.schedules)
+                {
+                    for (int chunk : settings.chunks)
+                    {
+                        if (schedule == best.schedule && chunk == best.chunkSize)
+                            continue;
+
+                        options.schedule = schedule;
+                        options.chunkSize = chunk;
+
+                        const double seconds = probeSeconds(funcBenchmark, options, best.threads, settings.runs);
+                        probes++;
+
+                        if (seconds < best.seconds)
+                            best = {.threads = best.threads, .schedule = schedule, .chunkSize = chunk, .seconds = seconds};
+                    }
+                }
+            }
+
+            profile.set(host, funcBenchmark.name, variant.name, best);
+
+            ostringstream speedup;
+            speedup << fixed << setprecision(1) << firstSeconds / best.seconds << "x";
+
+            printElement(threadLabel(best.threads), numWidth);
+            printElement(scheduleNames[int(best.schedule)], numWidth);
+            printElement(best.chunkSize, numWidth);
+            printElementPrecise(chrono::duration<double>(best.seconds), numWidth);
+            printElement(speedup.str(), numWidth);
+            printElement(probes, numWidth);
+            cout << endl;
+        }
+    }
+
+    profile.save(settings.path);
+
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+
+    cout << endl;
+    cout << "Saved " << profile.count(host) << " settings to " << settings.path << endl;
+    cout << "Tuning time: " << elapsed << endl;
+    cout << endl;
+
+    return 0;
+}